@@ -0,0 +1,189 @@
+//
+//  bench_ast.cpp
+//  epita-LibBistro
+//
+//  Evaluation time of the virtual AST nodes and of the std::variant ones,
+//  walked and computed the same way: only the dispatch and the layout of
+//  the nodes differ.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../src/ast-factory.hh"
+#include "../src/ast-variant.hh"
+#include "../src/base.hh"
+#include "../src/bignum.hh"
+
+using value_t = uint8_t;
+using base_t = bistro::Base<value_t>;
+using bignum_t = bistro::BigNum<value_t>;
+using ast_t = bistro::ASTNode<bignum_t, base_t>;
+using node_t = std::shared_ptr<ast_t>;
+using num_t = ast_t::num_t;
+using variant_t = bistro::VariantAST<bignum_t, base_t>;
+using clock_type = std::chrono::steady_clock;
+
+/// Best time of \a n calls to \a f, in milliseconds.
+template <typename F>
+static double best_time(size_t n, const F& f)
+{
+    double best = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        auto start = clock_type::now();
+        f();
+        std::chrono::duration<double, std::milli> d = clock_type::now() - start;
+        best = i ? std::min(best, d.count()) : d.count();
+    }
+    return best;
+}
+
+/**
+** Evaluate the tree of root \a root as VariantAST::eval does, in post-order
+** with an explicit stack and the sums and negations in place, through the
+** virtual methods of the nodes.
+**/
+static num_t virtual_eval(const ast_t& root)
+{
+    // Nodes to visit, and whether their operands are evaluated.
+    std::vector<std::pair<const ast_t*, bool>> todo = {{&root, false}};
+    std::vector<num_t> values;
+    std::vector<const ast_t*> operands;
+    while (!todo.empty())
+    {
+        auto [node, ready] = todo.back();
+        todo.pop_back();
+        auto kind = node->get_kind();
+        if (kind == bistro::NodeKind::NUMBER)
+            values.push_back(node->get_num());
+        else if (!ready)
+        {
+            todo.emplace_back(node, true);
+            operands.clear();
+            node->get_operands(operands);
+            for (auto it = operands.rbegin(); it != operands.rend(); ++it)
+                todo.emplace_back(*it, false);
+        }
+        else if (kind == bistro::NodeKind::UNOP)
+        {
+            num_t& operand = values.back();
+            if (node->get_op() != bistro::OpType::MINUS)
+                continue;
+            if (operand.use_count() == 1)
+                operand->set_positive(!operand->is_positive());
+            else
+                operand = std::make_shared<bignum_t>(
+                    bistro::negate(*operand));
+        }
+        else
+        {
+            num_t rhs = std::move(values.back());
+            values.pop_back();
+            num_t& lhs = values.back();
+            auto op = node->get_op();
+            if (op == bistro::OpType::PLUS && lhs.use_count() == 1)
+                *lhs += *rhs;
+            else if (op == bistro::OpType::MINUS && lhs.use_count() == 1)
+                *lhs -= *rhs;
+            else
+                lhs = std::make_shared<bignum_t>(
+                    bistro::apply(op, *lhs, *rhs));
+        }
+    }
+    return values.back();
+}
+
+/// Print the evaluation time of \a ast in both representations.
+static void bench(const std::string& name, const node_t& ast, size_t n)
+{
+    variant_t variant;
+    auto root = variant.add_tree(*ast);
+    auto A = base_t{'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+    // Both must agree before being timed.
+    std::string virt_res;
+    std::string var_res;
+    {
+        std::ostringstream out;
+        virtual_eval(*ast)->print(out, A);
+        virt_res = out.str();
+    }
+    {
+        std::ostringstream out;
+        variant.eval(root)->print(out, A);
+        var_res = out.str();
+    }
+    if (virt_res != var_res)
+    {
+        std::cerr << name << ": results differ\n";
+        return;
+    }
+
+    double virt = best_time(n, [&]() { virtual_eval(*ast); });
+    double var = best_time(n, [&]() { variant.eval(root); });
+    std::cout << name << " (" << variant.size() << " nodes, "
+              << sizeof(variant_t::node_t) << " bytes each): virtual "
+              << virt << " ms, variant " << var << " ms, speedup "
+              << virt / var << "\n";
+}
+
+int main(int argc, char* argv[])
+{
+    size_t size = argc > 1 ? std::stoul(argv[1]) : 1 << 20;
+    size_t n = argc > 2 ? std::stoul(argv[2]) : 5;
+
+    auto A = base_t{'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    auto fact = bistro::ASTFactory<bignum_t, base_t>();
+    std::vector<node_t> leaves;
+    for (size_t i = 0; i < size; i++)
+        leaves.push_back(fact(std::make_shared<bignum_t>(
+            std::string_view(std::to_string(i % 1000)), A)));
+
+    // A balanced sum of small numbers, keeping the values small, so that
+    // the dispatch weighs in.
+    std::vector<node_t> level = leaves;
+    for (size_t k = 0; level.size() > 1; k++)
+    {
+        std::vector<node_t> next;
+        for (size_t i = 0; i + 1 < level.size(); i += 2)
+            next.push_back(fact(level[i], level[i + 1],
+                                (i + k) % 3 ? bistro::OpType::PLUS
+                                            : bistro::OpType::MINUS));
+        if (level.size() % 2)
+            next.push_back(level.back());
+        level = std::move(next);
+    }
+    bench("balanced", level[0], n);
+
+    // The same numbers negated, in a comb of depth 64.
+    std::vector<node_t> combs;
+    for (size_t i = 0; i < size; i += 64)
+    {
+        node_t comb = leaves[i];
+        for (size_t j = i + 1; j < std::min(size, i + 64); j++)
+            comb = fact(fact(comb, bistro::OpType::MINUS), leaves[j],
+                        bistro::OpType::PLUS);
+        combs.push_back(comb);
+    }
+    while (combs.size() > 1)
+    {
+        std::vector<node_t> next;
+        for (size_t i = 0; i + 1 < combs.size(); i += 2)
+            next.push_back(fact(combs[i], combs[i + 1],
+                                bistro::OpType::PLUS));
+        if (combs.size() % 2)
+            next.push_back(combs.back());
+        combs = std::move(next);
+    }
+    bench("combs", combs[0], n);
+
+    return 0;
+}
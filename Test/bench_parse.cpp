@@ -0,0 +1,87 @@
+//
+//  bench_parse.cpp
+//  epita-LibBistro
+//
+//  Per-request latency of parsing and evaluating small expressions.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/parse-driver.hh"
+
+using bistro::parser::ParseDriver;
+using clock_type = std::chrono::steady_clock;
+
+static const std::string input = "10\n0123456789\n(12+34)*56+789\n";
+
+/// Time \a request \a n times and print the mean, median and p99 latency.
+static void bench(const std::string& name, size_t n,
+                  const std::function<void()>& request)
+{
+    std::vector<double> times;
+    times.reserve(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        auto start = clock_type::now();
+        request();
+        std::chrono::duration<double, std::micro> d = clock_type::now() - start;
+        times.push_back(d.count());
+    }
+    std::sort(times.begin(), times.end());
+    double sum = 0;
+    for (auto t : times)
+        sum += t;
+    std::cout << name << ": mean " << sum / n << " us, p50 "
+              << times[n / 2] << " us, p99 " << times[n * 99 / 100]
+              << " us\n";
+}
+
+/// Evaluate the first AST parsed by \a p and output the result.
+static void eval(const ParseDriver& p)
+{
+    p.visit([](const auto& program)
+    {
+        std::ostringstream out;
+        program.asts.front()->eval()->print(out, program.base);
+    });
+}
+
+int main(int argc, char* argv[])
+{
+    size_t n = argc > 1 ? std::stoul(argv[1]) : 100000;
+
+    std::string tmp = "/tmp/bench_parse.txt";
+    bench("temp file", n, [&]()
+    {
+        std::ofstream(tmp) << input;
+        ParseDriver p(tmp);
+        p.parse();
+        eval(p);
+    });
+    std::remove(tmp.c_str());
+
+    bench("parse_string", n, [&]()
+    {
+        ParseDriver p;
+        p.parse_string(input);
+        eval(p);
+    });
+
+    std::string buffer = input + std::string(2, '\0');
+    bench("parse_buffer", n, [&]()
+    {
+        ParseDriver p;
+        p.parse_buffer(buffer.data(), input.size());
+        eval(p);
+    });
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+//
+//  bench_pratt.cpp
+//  epita-LibBistro
+//
+//  Parsing throughput of the bison and the hand-written parsers.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "../src/parse-driver.hh"
+
+using bistro::parser::ParseDriver;
+using clock_type = std::chrono::steady_clock;
+
+static const std::string header = "10\n0123456789\n";
+
+/// Parse \a input \a n times with \a parser, and return the best time.
+static double time_parse(const std::string& input,
+                         ParseDriver::ParserType parser, size_t n)
+{
+    double best = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        ParseDriver p;
+        p.set_parser(parser);
+        auto start = clock_type::now();
+        p.parse_string(input);
+        std::chrono::duration<double, std::milli> d = clock_type::now() - start;
+        best = i ? std::min(best, d.count()) : d.count();
+    }
+    return best;
+}
+
+/// Print the parsing time of \a input by both parsers.
+static void bench(const std::string& name, const std::string& input, size_t n)
+{
+    double bison = time_parse(input, ParseDriver::ParserType::BISON, n);
+    double pratt = time_parse(input, ParseDriver::ParserType::PRATT, n);
+    std::cout << name << " (" << input.size() / 1024 << " KiB): bison "
+              << bison << " ms, pratt " << pratt << " ms, speedup "
+              << bison / pratt << "\n";
+}
+
+int main(int argc, char* argv[])
+{
+    size_t size = argc > 1 ? std::stoul(argv[1]) : 100000;
+    size_t n = argc > 2 ? std::stoul(argv[2]) : 5;
+
+    // One long line of operators of mixed priorities.
+    std::string wide = header;
+    for (size_t i = 0; i < size; i++)
+        wide += std::to_string(i) + (i % 3 ? "+" : "*");
+    wide += "1\n";
+    bench("wide", wide, n);
+
+    // Many short lines.
+    std::string lines = header;
+    for (size_t i = 0; i < size; i++)
+        lines += "(12+34)*56-" + std::to_string(i) + "\n";
+    bench("lines", lines, n);
+
+    // Few operators between long literals.
+    std::string literals = header;
+    for (size_t i = 0; i < size / 100; i++)
+        literals += std::string(1000, '0' + i % 10) + (i % 10 ? "+" : "\n");
+    literals += "1\n";
+    bench("literals", literals, n);
+
+    // Nested parentheses and unary operators, kept under the stack limit.
+    size_t depth = std::min<size_t>(size, 10000);
+    std::string deep = header;
+    for (size_t i = 0; i < depth; i++)
+        deep += "-(1+";
+    deep += "1";
+    deep += std::string(depth, ')');
+    deep += "\n";
+    bench("deep", deep, n);
+
+    return 0;
+}
@@ -10,7 +10,25 @@
 #include "catch.hpp"
 #include "../src/base.hh"
 #include "../src/bignum.hh"
+#include "../src/bignum-view.hh"
+#include "../src/digit-run.hh"
+#include "../src/ast-flat.hh"
+#include "../src/ast-rebalance.hh"
+#include "../src/ast-simplify.hh"
+#include "../src/ast-variant.hh"
+#include "../src/ast-shared.hh"
+#include "../src/bytecode.hh"
+#include "../src/thread-pool.hh"
+#include "../src/parse-driver.hh"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
 #include <initializer_list>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unistd.h>
 
 TEST_CASE(  "Check Base")
 {
@@ -35,3 +53,731 @@ TEST_CASE(  "Check Base")
     b2.print(std::cout, A);
     std::cout << '\n';
 }
+
+TEST_CASE(  "Check BigNum with a compile-time radix")
+{
+    using value_t = uint8_t;
+    using bignum_t = bistro::BigNum<value_t, 10>;
+    using base_t = bistro::Base<value_t>;
+    auto A = base_t{'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+    REQUIRE_THROWS_AS( bignum_t(16), std::invalid_argument);
+
+    auto a = bignum_t(10);
+    a.set_digit(0, 9);
+    a.set_digit(1, 9);
+    auto b = bignum_t(10);
+    b.set_digit(0, 7);
+
+    auto sum = a + b;
+    REQUIRE( sum.get_num_digits() == 3);
+    REQUIRE( sum.get_digit(0) == 6);
+    REQUIRE( sum.get_digit(1) == 0);
+    REQUIRE( sum.get_digit(2) == 1);
+
+    auto prod = a * b;
+    std::ostringstream out;
+    prod.print(out, A);
+    REQUIRE( out.str() == "693");
+}
+
+TEST_CASE(  "Check BigNum packed in a power-of-two base")
+{
+    using value_t = uint8_t;
+    using packed_t = bistro::BigNum<value_t, 16>;
+    using bignum_t = bistro::BigNum<value_t>;
+    using base_t = bistro::Base<value_t>;
+    auto A = base_t{'0', '1', '2', '3', '4', '5', '6', '7',
+                    '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
+
+    std::istringstream in1("123456789ABCDEF0123");
+    std::istringstream in2("FEDCBA9876543210");
+    auto a = packed_t(in1, A);
+    auto b = packed_t(in2, A);
+    REQUIRE( a.get_num_digits() == 19);
+    REQUIRE( a.get_digit(0) == 3);
+    REQUIRE( a.get_digit(18) == 1);
+
+    std::istringstream in3("123456789ABCDEF0123");
+    std::istringstream in4("FEDCBA9876543210");
+    auto c = bignum_t(in3, A);
+    auto d = bignum_t(in4, A);
+
+    std::ostringstream packed_out;
+    std::ostringstream out;
+    (a * b + a).print(packed_out, A);
+    (c * d + c).print(out, A);
+    REQUIRE( packed_out.str() == out.str());
+
+    a.set_digit(30, 0xA);
+    REQUIRE( a.get_num_digits() == 31);
+    a.set_digit(30, 0);
+    REQUIRE( a.get_num_digits() == 19);
+}
+
+TEST_CASE(  "Check BigNum from a digit string")
+{
+    using value_t = uint8_t;
+    using base_t = bistro::Base<value_t>;
+    auto A = base_t{'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+    auto a = bistro::BigNum<value_t>(std::string_view("1203"), A);
+    REQUIRE( a.get_num_digits() == 4);
+    REQUIRE( a.get_digit(0) == 3);
+    REQUIRE( a.get_digit(3) == 1);
+
+    REQUIRE_THROWS_AS( bistro::BigNum<value_t>(std::string_view(""), A),
+                       std::length_error);
+    REQUIRE_THROWS_AS( bistro::BigNum<value_t>(std::string_view("1x"), A),
+                       std::out_of_range);
+
+    // A zero result has no digits, and no sign.
+    auto minus = a.clone();
+    minus.set_positive(false);
+    std::ostringstream zero;
+    (minus + a).print(zero, A) << ' ';
+    (a - a).print_rpol(zero, A);
+    REQUIRE( zero.str() == "0 0");
+
+    // Zero-padded literals lose their leading zeros.
+    auto padded = bistro::BigNum<value_t>(std::string_view("007"), A);
+    REQUIRE( padded.get_num_digits() == 1);
+    auto one = bistro::BigNum<value_t>(std::string_view("1"), A);
+    auto zeros = bistro::BigNum<value_t, 10>(std::string_view("000"), A);
+    REQUIRE( zeros.get_num_digits() == 0);
+    std::ostringstream unpadded;
+    (padded + one).print(unpadded, A) << ' ';
+    padded.set_positive(false);
+    padded.print(unpadded, A) << ' ';
+    zeros.print(unpadded, A);
+    REQUIRE( unpadded.str() == "8 -7 0");
+}
+
+TEST_CASE(  "Check BigNum large products and conversion to another base")
+{
+    using value_t = uint8_t;
+    using base_t = bistro::Base<value_t>;
+    auto A = base_t{'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    auto H = base_t{'0', '1', '2', '3', '4', '5', '6', '7',
+                    '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
+
+    // (10^100 - 1)^2, large enough for a Karatsuba product.
+    auto n = bistro::BigNum<value_t>(std::string(100, '9'), A);
+    std::ostringstream square;
+    (n * n).print(square, A);
+    REQUIRE( square.str() == std::string(99, '9') + '8'
+                             + std::string(99, '0') + '1');
+
+    // 16^40 - 1, large enough to be split in halves.
+    auto a = bistro::BigNum<value_t, 16>(std::string(40, 'F'), H);
+    std::ostringstream out;
+    a.print(out, A);
+    REQUIRE( out.str() == "1461501637330902918203684832716283019655932542975");
+
+    std::ostringstream back;
+    a.convert(A).print(back, H);
+    REQUIRE( back.str() == std::string(40, 'F'));
+}
+
+TEST_CASE(  "Check BigNum parsing of a literal in another base")
+{
+    using value_t = uint8_t;
+    using base_t = bistro::Base<value_t>;
+    auto A = base_t{'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    auto H = base_t{'0', '1', '2', '3', '4', '5', '6', '7',
+                    '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
+
+    // 16^40 - 1, split in halves converted on two threads.
+    auto dec = "1461501637330902918203684832716283019655932542975";
+    auto a = bistro::BigNum<value_t, 16>(std::string_view(dec), A, 2);
+    std::ostringstream out;
+    a.print(out, H);
+    REQUIRE( out.str() == std::string(40, 'F'));
+
+    // The powers cached for 10 to 16 are dropped for 16 to 10, and back.
+    std::ostringstream round;
+    a.convert(A).print(round, A);
+    REQUIRE( round.str() == dec);
+    auto c = bistro::BigNum<value_t, 16>(std::string_view(dec), A);
+    REQUIRE( c == a);
+
+    // The only digit of base 1 is 0.
+    auto U = base_t{'0'};
+    auto zero = bistro::BigNum<value_t, 16>(std::string_view("000"), U);
+    REQUIRE( zero.get_num_digits() == 0);
+
+    std::istringstream in("1203+4");
+    auto b = bistro::BigNum<value_t>(in, A);
+    REQUIRE( b.get_num_digits() == 4);
+    REQUIRE( in.peek() == '+');
+}
+
+TEST_CASE(  "Check BigNum binary save, load and view")
+{
+    using value_t = uint8_t;
+    using base_t = bistro::Base<value_t>;
+    auto H = base_t{'0', '1', '2', '3', '4', '5', '6', '7',
+                    '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
+
+    auto a = bistro::BigNum<value_t, 16>(std::string(40, 'F'), H);
+    a.set_positive(false);
+    std::stringstream bin;
+    a.save(bin);
+
+    auto b = bistro::BigNum<value_t, 16>::load(bin);
+    std::ostringstream out;
+    b.print(out, H);
+    REQUIRE( out.str() == '-' + std::string(40, 'F'));
+
+    // Aligned copy of the saved number, as a mapped file would be.
+    std::string saved = bin.str();
+    std::vector<uint64_t> buf(saved.size() / sizeof(uint64_t));
+    std::memcpy(buf.data(), saved.data(), saved.size());
+    using view_t = bistro::BigNumView<value_t, 16>;
+    auto v = view_t(buf.data(), saved.size());
+    REQUIRE( v.get_num_digits() == 40);
+    REQUIRE( v.get_digit(39) == 15);
+    REQUIRE( !v.is_positive());
+
+    REQUIRE_THROWS_AS( bistro::BigNumView<value_t>(buf.data(), saved.size()),
+                       std::invalid_argument);
+    REQUIRE_THROWS_AS( view_t(buf.data(), 30),
+                       std::length_error);
+
+    // A number saved on a host of the other byte order.
+    using wide_t = bistro::BigNum<uint16_t>;
+    using header_t = bistro::BigNumHeader;
+    auto w = wide_t(300);
+    w.set_digit(0, 258);
+    w.set_digit(1, 299);
+    std::stringstream wide;
+    w.save(wide);
+    std::string foreign = wide.str();
+    auto reverse = [&foreign](size_t pos, size_t len)
+    {
+        std::reverse(foreign.begin() + pos, foreign.begin() + pos + len);
+    };
+    foreign[offsetof(header_t, big_endian)] ^= 1;
+    reverse(offsetof(header_t, base), sizeof(uint64_t));
+    reverse(offsetof(header_t, count), sizeof(uint64_t));
+    for (size_t i = sizeof(header_t); i < foreign.size(); i += 2)
+        reverse(i, 2);
+    std::istringstream foreign_in(foreign);
+    auto x = wide_t::load(foreign_in);
+    REQUIRE( x.get_base_num() == 300);
+    REQUIRE( x.get_digit(0) == 258);
+    REQUIRE( x.get_digit(1) == 299);
+    std::vector<uint64_t> foreign_buf(foreign.size() / sizeof(uint64_t));
+    std::memcpy(foreign_buf.data(), foreign.data(), foreign.size());
+    REQUIRE_THROWS_AS( bistro::BigNumView<uint16_t>(foreign_buf.data(),
+                                                    foreign.size()),
+                       std::invalid_argument);
+
+    // A corrupt count is rejected before allocating the limbs.
+    std::string huge = saved;
+    uint64_t count = uint64_t(1) << 60;
+    std::memcpy(&huge[offsetof(header_t, count)], &count, sizeof(count));
+    std::istringstream huge_in(huge);
+    REQUIRE_THROWS_AS( view_t::num_t::load(huge_in), std::length_error);
+
+    // So is a leading zero, packed or not.
+    std::string lead = wide.str();
+    lead.replace(lead.size() - 2, 2, 2, '\0');
+    std::istringstream lead_in(lead);
+    REQUIRE_THROWS_AS( wide_t::load(lead_in), std::invalid_argument);
+}
+
+TEST_CASE(  "Check the end of digit runs")
+{
+    using bistro::parser::find_digit_run_end;
+
+    std::string digits(100, '7');
+    for (char c : {'+', '-', '*', '/', '%', '(', ')', '\n'})
+        for (size_t i : {0, 5, 16, 31, 32, 70, 99})
+        {
+            std::string s = digits;
+            s[i] = c;
+            REQUIRE( find_digit_run_end(s.data(), s.data() + s.size())
+                     == s.data() + i);
+        }
+    REQUIRE( find_digit_run_end(digits.data(), digits.data() + digits.size())
+             == digits.data() + digits.size());
+}
+
+/**
+** Fixture of the AST tests: decimal numbers of uint8_t digits, and a
+** Factory building their nodes.
+**/
+template <template <typename, typename> class Factory>
+struct DecimalAST
+{
+    using value_t = uint8_t;
+    using base_t = bistro::Base<value_t>;
+    using bignum_t = bistro::BigNum<value_t>;
+    using ast_t = bistro::ASTNode<bignum_t, base_t>;
+    using code_t = bistro::Bytecode<bignum_t, base_t>;
+
+    const base_t A{'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    const Factory<bignum_t, base_t> fact;
+
+    /// Number of decimal digits \a s.
+    std::shared_ptr<bignum_t> big(const std::string& s) const
+    {
+        return std::make_shared<bignum_t>(std::string_view(s), A);
+    }
+
+    /// Node of the number of decimal digits \a s.
+    typename ast_t::node_t num(const std::string& s) const
+    {
+        return fact(big(s));
+    }
+
+    /// \a n written in decimal.
+    std::string str(const bignum_t& n) const
+    {
+        std::ostringstream out;
+        n.print(out, A);
+        return out.str();
+    }
+};
+
+TEST_CASE_METHOD(DecimalAST<bistro::FlatASTFactory>, "Check the flat AST")
+{
+    auto sum = fact(num("12"), num("30"), bistro::OpType::PLUS);
+    auto ast = fact(sum, fact(num("5"), bistro::OpType::MINUS),
+                    bistro::OpType::TIMES);
+    REQUIRE( fact.get_ast().size() == 6);
+
+    std::ostringstream infix;
+    ast->print_infix(infix, A);
+    REQUIRE( infix.str() == "((12+30)*-5)");
+
+    std::ostringstream rpol;
+    ast->print_rpol(rpol, A);
+    REQUIRE( rpol.str() == "12 30 + 0 5 - *");
+
+    REQUIRE( str(*ast->eval()) == "-210");
+
+    // The nodes keep their arena alive.
+    decltype(ast) kept;
+    {
+        bistro::FlatASTFactory<bignum_t, base_t> local;
+        kept = local(local(big("7")), local(big("6")), bistro::OpType::TIMES);
+    }
+    std::ostringstream pol;
+    kept->print_pol(pol, A);
+    REQUIRE( pol.str() == "* 7 6");
+    REQUIRE( str(*kept->eval()) == "42");
+}
+
+TEST_CASE_METHOD(DecimalAST<bistro::ASTFactory>, "Check the bytecode")
+{
+    // -(7 - 100) * 3 ** 4 / 5 % 1000
+    auto diff = fact(num("7"), num("100"), bistro::OpType::MINUS);
+    auto pow = fact(num("3"), num("4"), bistro::OpType::POWER);
+    auto prod = fact(fact(diff, bistro::OpType::MINUS), pow,
+                     bistro::OpType::TIMES);
+    auto ast = fact(fact(prod, num("5"), bistro::OpType::DIVIDE),
+                    num("1000"), bistro::OpType::MODULO);
+
+    auto code = code_t::compile(*ast);
+    REQUIRE( code.get_code().size() == 12);
+    REQUIRE( code.get_code()[3].op == bistro::OpCode::NEG);
+
+    // The program may be run several times.
+    for (int i = 0; i < 2; i++)
+        REQUIRE( str(code.run()) == "506");
+    REQUIRE( str(*ast->eval()) == "506");
+}
+
+TEST_CASE_METHOD(DecimalAST<bistro::ASTFactory>, "Check the thread pool")
+{
+    bistro::ThreadPool pool(4);
+    REQUIRE( pool.size() == 4);
+
+    std::atomic<size_t> sum(0);
+    pool.parallel_for(1000, [&](size_t i) { sum += i; });
+    REQUIRE( sum == 499500);
+
+    REQUIRE_THROWS_AS( pool.parallel_for(10, [](size_t i)
+    {
+        if (i == 7)
+            throw std::runtime_error("task");
+    }), std::runtime_error);
+
+    // Sum of products large enough to be forked.
+    auto ast = num("1");
+    for (int i = 1; i <= 8; i++)
+    {
+        auto n = num(std::string(1000, '0' + i));
+        auto prod = fact(n, n, bistro::OpType::TIMES);
+        ast = fact(ast, prod, i % 2 ? bistro::OpType::PLUS
+                                    : bistro::OpType::MINUS);
+    }
+    auto code = code_t::compile(*ast);
+    auto seq = str(code.run());
+    REQUIRE( str(code.run(&pool)) == seq);
+    REQUIRE( seq.size() == 2001);
+}
+
+TEST_CASE_METHOD(DecimalAST<bistro::SharedASTFactory>, "Check the shared AST")
+{
+    // (12*34 + 12*34) * -(12*34)
+    auto prod = fact(num("12"), num("34"), bistro::OpType::TIMES);
+    REQUIRE( num("12") == num("12"));
+    REQUIRE( !prod->is_shared());
+    auto again = fact(num("12"), num("34"), bistro::OpType::TIMES);
+    REQUIRE( again == prod);
+    REQUIRE( prod->is_shared());
+    auto sum = fact(prod, again, bistro::OpType::PLUS);
+    auto ast = fact(sum, fact(prod, bistro::OpType::MINUS),
+                    bistro::OpType::TIMES);
+
+    REQUIRE( str(*ast->eval()) == "-332928");
+    REQUIRE( prod->eval() == prod->eval());
+
+    // The product is computed once, and loaded 3 times.
+    auto code = code_t::compile(*ast);
+    const auto& instrs = code.get_code();
+    REQUIRE( instrs.size() == 10);
+    REQUIRE( instrs[3].op == bistro::OpCode::SAVE);
+    REQUIRE( std::count_if(instrs.begin(), instrs.end(), [](auto& instr)
+    {
+        return instr.op == bistro::OpCode::LOAD;
+    }) == 3);
+    for (int i = 0; i < 2; i++)
+        REQUIRE( str(code.run()) == "-332928");
+
+    // -0 is equal to 0, and so is its node.
+    auto neg_zero = big("0");
+    neg_zero->set_positive(false);
+    REQUIRE( fact(neg_zero) == num("0"));
+
+    // A product shared by two expressions is computed by the first program
+    // run, and kept in its memo for the other.
+    auto lines = bistro::SharedASTFactory<bignum_t, base_t>();
+    auto line = [&](bistro::OpType op)
+    {
+        auto prod = lines(lines(big("12")), lines(big("12")),
+                          bistro::OpType::TIMES);
+        return lines(prod, lines(big("1")), op);
+    };
+    auto first = line(bistro::OpType::PLUS);
+    auto second = line(bistro::OpType::MINUS);
+    std::vector<const ast_t*> operands;
+    first->get_operands(operands);
+    auto memo = operands.front()->get_memo();
+    REQUIRE( memo);
+    REQUIRE( !memo->get());
+    REQUIRE( str(code_t::compile(*first).run()) == "145");
+    auto value = memo->get();
+    REQUIRE( value);
+    REQUIRE( str(code_t::compile(*second).run()) == "143");
+    REQUIRE( memo->get() == value);
+}
+
+TEST_CASE_METHOD(DecimalAST<bistro::ASTFactory>,
+                 "Check the rebalancing of chains")
+{
+    std::function<size_t(const ast_t&)> depth = [&](const ast_t& node)
+    {
+        std::vector<const ast_t*> operands;
+        node.get_operands(operands);
+        size_t res = 0;
+        for (auto operand : operands)
+            res = std::max(res, depth(*operand));
+        return res + 1;
+    };
+    auto rebalance = bistro::Rebalancer<bignum_t, base_t>(fact);
+
+    // 1 * 2 * ... * 16, and 1 - 2 + 3 - ... - 16.
+    auto prod = num("1");
+    auto sum = num("1");
+    for (int i = 2; i <= 16; i++)
+    {
+        prod = fact(prod, num(std::to_string(i)), bistro::OpType::TIMES);
+        sum = fact(sum, num(std::to_string(i)),
+                   i % 2 ? bistro::OpType::PLUS : bistro::OpType::MINUS);
+    }
+    REQUIRE( depth(*prod) == 16);
+
+    auto balanced = rebalance(*prod);
+    REQUIRE( depth(*balanced) <= 6);
+    REQUIRE( str(*balanced->eval()) == "20922789888000");
+
+    balanced = rebalance(*sum);
+    REQUIRE( depth(*balanced) == 5);
+    REQUIRE( balanced->get_op() == bistro::OpType::MINUS);
+    REQUIRE( str(*balanced->eval()) == "-8");
+
+    // Other operators are kept.
+    auto quot = fact(prod, fact(num("3"), num("4"), bistro::OpType::TIMES),
+                     bistro::OpType::DIVIDE);
+    balanced = rebalance(*quot);
+    REQUIRE( balanced->get_op() == bistro::OpType::DIVIDE);
+    REQUIRE( str(*balanced->eval()) == "1743565824000");
+}
+
+TEST_CASE_METHOD(DecimalAST<bistro::SharedASTFactory>,
+                 "Check the algebraic simplifications")
+{
+    auto simplify = bistro::Simplifier<bignum_t, base_t>(fact, A);
+    auto x = fact(num("12"), num("34"), bistro::OpType::TIMES);
+    auto eval = [&](const auto& ast)
+    {
+        return str(*simplify(*ast)->eval());
+    };
+
+    REQUIRE( simplify(*fact(x, num("1"), bistro::OpType::TIMES)) == x);
+    REQUIRE( simplify(*fact(num("0"), x, bistro::OpType::PLUS)) == x);
+    REQUIRE( simplify(*fact(x, num("1"), bistro::OpType::POWER)) == x);
+    auto neg = fact(fact(x, bistro::OpType::MINUS), bistro::OpType::MINUS);
+    REQUIRE( simplify(*neg) == x);
+
+    auto zero = simplify(*fact(x, num("0"), bistro::OpType::TIMES));
+    REQUIRE( zero->get_kind() == bistro::NodeKind::NUMBER);
+    REQUIRE( eval(zero) == "0");
+    REQUIRE( eval(fact(x, x, bistro::OpType::MINUS)) == "0");
+    REQUIRE( eval(fact(x, num("0"), bistro::OpType::POWER)) == "1");
+    REQUIRE( eval(fact(num("0"), x, bistro::OpType::MINUS)) == "-408");
+
+    // The errors are kept.
+    auto div0 = fact(x, num("0"), bistro::OpType::DIVIDE);
+    REQUIRE_THROWS_AS( simplify(*fact(div0, num("0"), bistro::OpType::TIMES))
+                       ->eval(), std::overflow_error);
+    REQUIRE_THROWS_AS( simplify(*fact(num("0"), fact(x, x,
+                                                     bistro::OpType::MINUS),
+                                      bistro::OpType::DIVIDE))->eval(),
+                       std::overflow_error);
+
+    // Base 1 has no 1: only the identities on 0 apply.
+    auto U = base_t{'0'};
+    auto ufact = bistro::SharedASTFactory<bignum_t, base_t>();
+    auto unary = bistro::Simplifier<bignum_t, base_t>(ufact, U);
+    auto u = ufact(std::make_shared<bignum_t>(std::string_view("000"), U));
+    REQUIRE( unary(*ufact(u, u, bistro::OpType::PLUS)) == u);
+    auto pow = unary(*ufact(u, u, bistro::OpType::POWER));
+    REQUIRE( pow->get_kind() == bistro::NodeKind::BINOP);
+    REQUIRE_THROWS_AS( pow->eval(), std::invalid_argument);
+}
+
+TEST_CASE_METHOD(DecimalAST<bistro::ASTFactory>,
+                 "Check the size bounds and the memory budget")
+{
+    REQUIRE( bistro::result_digits(bistro::OpType::TIMES, 10, 20, 0) == 30);
+    REQUIRE( bistro::result_digits(bistro::OpType::PLUS, 10, 20, 0) == 21);
+    REQUIRE( bistro::result_digits(bistro::OpType::POWER, 10, 1, 7) == 70);
+    REQUIRE( bistro::result_digits(bistro::OpType::MODULO, 10, 20, 0) == 10);
+
+    // (x * x) ** 3 + -x, with x of 100 digits.
+    auto x = num(std::string(100, '9'));
+    auto ast = fact(fact(fact(x, x, bistro::OpType::TIMES), num("3"),
+                         bistro::OpType::POWER),
+                    fact(x, bistro::OpType::MINUS), bistro::OpType::PLUS);
+    auto code = code_t::compile(*ast);
+    // The cube, -x and the sum, x * x being freed once cubed.
+    REQUIRE( code.get_peak_bytes() == 600 + 100 + 601);
+    REQUIRE_NOTHROW( code.check_budget(1301));
+    REQUIRE_THROWS_AS( code.check_budget(1300), std::length_error);
+    REQUIRE( str(code.run()).size() == 600);
+
+    // A number set from its most significant digit grows once.
+    auto n = bignum_t(10);
+    n.reserve(50);
+    n.set_digit(49, 1);
+    REQUIRE( n.get_num_digits() == 50);
+    REQUIRE( bignum_t::digit_bytes() == 1);
+    REQUIRE( bistro::BigNum<uint8_t, 16>::digit_bytes() == 0.5);
+}
+
+TEST_CASE_METHOD(DecimalAST<bistro::ASTFactory>,
+                 "Check the evaluation order and the sums in place")
+{
+    // -x - (x * x) ** 3 % 7, with x of 100 digits.
+    auto x = num(std::string(100, '9'));
+    auto cube = fact(fact(x, x, bistro::OpType::TIMES), num("3"),
+                     bistro::OpType::POWER);
+    auto ast = fact(fact(x, bistro::OpType::MINUS),
+                    fact(cube, num("7"), bistro::OpType::MODULO),
+                    bistro::OpType::MINUS);
+    auto code = code_t::compile(*ast);
+    // The right operand needs more memory: -x is not alive meanwhile.
+    REQUIRE( code.get_code().back().arg == 1);
+    REQUIRE( code.get_code().front().op == bistro::OpCode::PUSH_LIT);
+    REQUIRE( code.get_peak_bytes() == 200 + 600);
+    REQUIRE( str(code.run()) == "-1" + std::string(100, '0'));
+
+    // The sums in place, including with the number itself.
+    auto a = bignum_t(std::string_view("999"), A);
+    a += a;
+    REQUIRE( str(a) == "1998");
+    a -= *big("2000");
+    REQUIRE( str(a) == "-2");
+    a -= a;
+    REQUIRE( !a);
+}
+
+TEST_CASE_METHOD(DecimalAST<bistro::ASTFactory>,
+                 "Check the printing of a tree")
+{
+    // (7 % -(2 ** 3)) / 10
+    auto pow = fact(num("2"), num("3"), bistro::OpType::POWER);
+    auto mod = fact(num("7"), fact(pow, bistro::OpType::MINUS),
+                    bistro::OpType::MODULO);
+    auto ast = fact(mod, num("10"), bistro::OpType::DIVIDE);
+
+    std::ostringstream infix;
+    ast->print_infix(infix, A);
+    REQUIRE( infix.str() == "((7%-(2**3))/10)");
+
+    std::ostringstream pol;
+    ast->print_pol(pol, A);
+    REQUIRE( pol.str() == "/ % 7 - 0 ** 2 3 10");
+
+    std::ostringstream rpol;
+    ast->print_rpol(rpol, A);
+    REQUIRE( rpol.str() == "7 0 2 3 ** - % 10 /");
+
+    // A deep tree is printed without recursion.
+    auto flat = bistro::FlatASTFactory<bignum_t, base_t>();
+    auto one = big("1");
+    auto deep = flat(one);
+    const size_t depth = 1000000;
+    for (size_t i = 0; i < depth; i++)
+        deep = flat(deep, flat(one), bistro::OpType::PLUS);
+    std::ostringstream deep_out;
+    deep->print_infix(deep_out, A);
+    REQUIRE( deep_out.str().size() == 4 * depth + 1);
+    REQUIRE( deep_out.str().substr(deep_out.str().size() - 4) == ")+1)");
+}
+
+TEST_CASE_METHOD(DecimalAST<bistro::SharedASTFactory>,
+                 "Check the variant AST")
+{
+    using variant_t = bistro::VariantAST<bignum_t, base_t>;
+    REQUIRE( sizeof(variant_t::node_t) == 16);
+
+    // (12 + 30) * -5
+    variant_t ast;
+    auto sum = ast.add_binop(ast.add_number(big("12")),
+                             ast.add_number(big("30")), bistro::OpType::PLUS);
+    auto root = ast.add_binop(sum, ast.add_unop(ast.add_number(big("5")),
+                                                bistro::OpType::MINUS),
+                              bistro::OpType::TIMES);
+    REQUIRE( ast.size() == 6);
+    REQUIRE( str(*ast.eval(root)) == "-210");
+    // The literals are not modified by the sums in place.
+    REQUIRE( str(*ast.eval(root)) == "-210");
+
+    // A shared AST is converted with its shared nodes added once.
+    auto x = num("7");
+    auto sq = fact(x, x, bistro::OpType::TIMES);
+    auto tree = fact(fact(sq, bistro::OpType::MINUS),
+                     fact(x, x, bistro::OpType::TIMES),
+                     bistro::OpType::MINUS);
+    variant_t conv;
+    auto conv_root = conv.add_tree(*tree);
+    // x, x, x * x, its opposite and the difference.
+    REQUIRE( conv.size() == 5);
+    REQUIRE( str(*conv.eval(conv_root)) == "-98");
+}
+
+TEST_CASE( "Check the radix of the programs parsed")
+{
+    using driver_t = bistro::parser::ParseDriver;
+    driver_t driver;
+    driver.set_parser(driver_t::ParserType::PRATT);
+    // Parse and evaluate \a input, and get the static radix of its numbers,
+    // whether they are packed, and the value of its first expression.
+    struct parsed
+    {
+        size_t radix;
+        bool packed;
+        std::string value;
+    };
+    auto parse = [&](const std::string& input)
+    {
+        driver.parse_string(input);
+        return driver.visit([](const auto& program)
+        {
+            using num_t = typename std::decay_t<decltype(program)>::num_t;
+            std::ostringstream out;
+            program.asts.front()->eval()->print(out, program.base);
+            return parsed{num_t::static_radix, num_t::is_packed, out.str()};
+        });
+    };
+
+    auto dec = parse("10\n0123456789\n99999999999999999999+1\n");
+    REQUIRE( dec.radix == 10);
+    REQUIRE( !dec.packed);
+    REQUIRE( dec.value == "100000000000000000000");
+
+    auto hex = parse("16\n0123456789ABCDEF\nFFFFFFFFFFFFFFFF*-FF\n");
+    REQUIRE( hex.radix == 16);
+    REQUIRE( hex.packed);
+    REQUIRE( hex.value == "-FEFFFFFFFFFFFFFF01");
+
+    auto bin = parse("2\nab\nbaab-bab\n");
+    REQUIRE( bin.radix == 2);
+    REQUIRE( bin.packed);
+    REQUIRE( bin.value == "baa");
+
+    auto oct = parse("8\n01234567\n777/7\n");
+    REQUIRE( oct.radix == 8);
+    REQUIRE( oct.value == "111");
+
+    // Other bases keep a runtime radix.
+    auto sept = parse("7\n0123456\n66+1\n");
+    REQUIRE( sept.radix == 0);
+    REQUIRE( sept.value == "100");
+}
+
+TEST_CASE( "Check the parsing of a pipe")
+{
+    using driver_t = bistro::parser::ParseDriver;
+    for (auto parser : {driver_t::ParserType::BISON,
+                        driver_t::ParserType::PRATT})
+    {
+        int fds[2];
+        REQUIRE( pipe(fds) == 0);
+        const std::string input = "10\n0123456789\n12*34\n";
+        REQUIRE( write(fds[1], input.data(), input.size())
+                 == ssize_t(input.size()));
+        close(fds[1]);
+
+        // A pipe has no size: it is read, not mapped.
+        driver_t driver("/dev/fd/" + std::to_string(fds[0]));
+        driver.set_parser(parser);
+        driver.parse();
+        close(fds[0]);
+        REQUIRE( !driver.get_error());
+        driver.visit([](const auto& program)
+        {
+            REQUIRE( program.asts.size() == 1);
+            std::ostringstream out;
+            program.asts.front()->eval()->print(out, program.base);
+            REQUIRE( out.str() == "408");
+        });
+    }
+}
+
+TEST_CASE( "Check the parsing of an invalid base length")
+{
+    using driver_t = bistro::parser::ParseDriver;
+    for (auto parser : {driver_t::ParserType::BISON,
+                        driver_t::ParserType::PRATT})
+    {
+        driver_t driver;
+        driver.set_parser(parser);
+        // 2^64 + 10 does not fit, and must not wrap to 10.
+        REQUIRE_THROWS_AS( driver.parse_string(
+                               "18446744073709551626\n0123456789\n1+1\n"),
+                           std::runtime_error);
+        REQUIRE( driver.get_error());
+
+        // The digits of a base are bytes below 255: 255 of them at most.
+        REQUIRE_THROWS_AS( driver.parse_string("256\n0123456789\n1+1\n"),
+                           std::runtime_error);
+        REQUIRE( driver.get_error());
+    }
+}
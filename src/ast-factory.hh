@@ -21,6 +21,9 @@ namespace bistro
     ** This is an implementation of the factory pattern.
     ** A node may be constructed with one or two operand (nodes) and an operator
     ** (OpType, defined in ast-node header), or with a BigNum.
+    **
+    ** This factory allocates each node on its own; a derived factory may lay
+    ** them out differently, see FlatASTFactory.
     **/
     template <typename BigNum, typename Base>
     class ASTFactory 
@@ -35,17 +38,20 @@ namespace bistro
         
         ASTFactory() = default;
 
-        node_t operator()(const node_t& lhs, OpType op) const
+        virtual ~ASTFactory() = default;
+
+        virtual node_t operator()(const node_t& lhs, OpType op) const
         {
             return std::make_shared<UnOpNode<BigNum, Base>>(lhs, op);
         }
 
-        node_t operator()(const node_t& lhs, const node_t& rhs, OpType op) const
+        virtual node_t
+        operator()(const node_t& lhs, const node_t& rhs, OpType op) const
         {
             return std::make_shared<BinOpNode<BigNum, Base>>(lhs, rhs, op);
         }
 
-        node_t operator()(const std::shared_ptr<num_t>& num) const
+        virtual node_t operator()(const std::shared_ptr<num_t>& num) const
         {
             return std::make_shared<NumberNode<BigNum, Base>>(num);
         }
@@ -0,0 +1,336 @@
+#pragma once
+
+#include <cstdint> // uint32_t
+#include <limits>
+#include <memory> // shared_ptr, unique_ptr
+#include <mutex> // call_once
+#include <ostream>
+#include <stdexcept> // length_error
+#include <type_traits>
+#include <utility> // pair
+#include <vector>
+
+#include "ast-node.hh"
+#include "ast-factory.hh"
+#include "bytecode.hh"
+
+namespace bistro
+{
+    /**
+    ** Arena holding the nodes of ASTs, see FlatASTFactory.
+    **
+    ** The nodes are stored contiguously, in blocks that never move, as
+    ** trivially destructible records referring to their operands by 32-bit
+    ** indices; the literals are kept in a side table. The ASTNode of a node
+    ** is a FlatNode, built on demand.
+    **/
+    template <typename BigNum, typename Base>
+    class FlatAST
+    {
+    public:
+        /// Index of a node.
+        using index_t = uint32_t;
+
+        /// Shared_ptr to a BigNum.
+        using num_t = std::shared_ptr<BigNum>;
+
+        /// Kind of node.
+        using Kind = NodeKind;
+
+        /**
+        ** Node of the arena. \a lhs is the index of the literal of a NUMBER,
+        ** of the operand of a UNOP; \a rhs is only used by a BINOP.
+        **/
+        struct record_t
+        {
+            index_t lhs;
+            index_t rhs;
+            Kind kind;
+            OpType op;
+        };
+        static_assert(std::is_trivially_destructible<record_t>::value,
+                      "the records are freed without destructor");
+
+        /// Add a node for the number \a num.
+        index_t add_number(const num_t& num)
+        {
+            literals_.push_back(num);
+            return add(Kind::NUMBER, OpType::PLUS, literals_.size() - 1, 0);
+        }
+
+        /// Add a node for the unary operation \a op on the node \a lhs.
+        index_t add_unop(index_t lhs, OpType op)
+        {
+            return add(Kind::UNOP, op, lhs, 0);
+        }
+
+        /// Add a node for the binary operation \a op on \a lhs and \a rhs.
+        index_t add_binop(index_t lhs, index_t rhs, OpType op)
+        {
+            return add(Kind::BINOP, op, lhs, rhs);
+        }
+
+        /// Get the node \a i.
+        const record_t& record(index_t i) const
+        {
+            return blocks_[i >> block_bits][i & (block_size - 1)];
+        }
+
+        /// Get the literal \a i.
+        const num_t& literal(index_t i) const
+        {
+            return literals_[i];
+        }
+
+        /// Number of nodes.
+        index_t size() const
+        {
+            return size_;
+        }
+
+        /**
+        ** Evaluate the tree of root \a root.
+        **
+        ** The tree is walked in post-order with an explicit stack, so that
+        ** deep trees do not overflow the call stack.
+        **/
+        num_t eval(index_t root) const
+        {
+            // Nodes to visit, and whether their operands are evaluated.
+            std::vector<std::pair<index_t, bool>> todo = {{root, false}};
+            std::vector<num_t> values;
+            while (!todo.empty())
+            {
+                auto [i, ready] = todo.back();
+                todo.pop_back();
+                const record_t& n = record(i);
+                if (n.kind == Kind::NUMBER)
+                {
+                    values.push_back(literals_[n.lhs]);
+                    continue;
+                }
+                if (!ready)
+                {
+                    todo.emplace_back(i, true);
+                    if (n.kind == Kind::BINOP)
+                        todo.emplace_back(n.rhs, false);
+                    todo.emplace_back(n.lhs, false);
+                    continue;
+                }
+                if (n.kind == Kind::UNOP)
+                {
+                    if (n.op == OpType::MINUS)
+                        values.back() = std::make_shared<BigNum>(
+                            negate(*values.back()));
+                    continue;
+                }
+                num_t rhs = std::move(values.back());
+                values.pop_back();
+                values.back() = std::make_shared<BigNum>(
+                    apply(n.op, *values.back(), *rhs));
+            }
+            return values.back();
+        }
+
+    private:
+        /// Each block holds 2^block_bits nodes.
+        static constexpr unsigned block_bits = 12;
+        static constexpr index_t block_size = index_t(1) << block_bits;
+
+        index_t add(Kind kind, OpType op, index_t lhs, index_t rhs)
+        {
+            if (size_ == std::numeric_limits<index_t>::max())
+                throw std::length_error("le in FlatAST");
+            if (!(size_ & (block_size - 1)))
+            {
+                blocks_.emplace_back();
+                blocks_.back().reserve(block_size);
+            }
+            blocks_.back().push_back(record_t{lhs, rhs, kind, op});
+            return size_++;
+        }
+
+        std::vector<std::vector<record_t>> blocks_;
+        index_t size_ = 0;
+        std::vector<num_t> literals_;
+    };
+
+    /**
+    ** ASTNode of a node of a FlatAST.
+    **
+    ** The view keeps the arena alive. The views of the operands are built the
+    ** first time they are asked for, and kept with the view.
+    **/
+    template <typename BigNum, typename Base>
+    class FlatNode : public ASTNode<BigNum, Base>
+    {
+    public:
+        /// The BigNum class used to represent the numbers.
+        using bignum_t = BigNum;
+
+        /// The Base class.
+        using base_t = Base;
+
+        /// Shared_ptr to a BigNum.
+        using num_t = std::shared_ptr<BigNum>;
+
+        using self_t = FlatNode;
+
+        /// Arena of the node.
+        using ast_t = FlatAST<BigNum, Base>;
+
+        /// Index of a node in its FlatAST.
+        using index_t = typename ast_t::index_t;
+
+        /// Kind of node.
+        using Kind = NodeKind;
+
+        /// View of the node \a index of \a ast.
+        FlatNode(std::shared_ptr<const ast_t> ast, index_t index)
+            : ast_(std::move(ast))
+            , index_(index)
+        {
+        }
+
+        /**
+        ** Free the views of the operands with an explicit stack, so that
+        ** deep trees do not overflow the call stack.
+        **/
+        ~FlatNode() override
+        {
+            std::vector<std::unique_ptr<const FlatNode>> todo;
+            for (auto& operand : operands_)
+                if (operand)
+                    todo.push_back(std::move(operand));
+            while (!todo.empty())
+            {
+                std::unique_ptr<const FlatNode> view = std::move(todo.back());
+                todo.pop_back();
+                for (auto& operand : view->operands_)
+                    if (operand)
+                        todo.push_back(std::move(operand));
+            }
+        }
+
+        /// Evaluate the tree and return a shared_pointer to the result.
+        num_t eval() const override
+        {
+            return ast_->eval(index_);
+        }
+
+        NodeKind get_kind() const override
+        {
+            return ast_->record(index_).kind;
+        }
+
+        OpType get_op() const override
+        {
+            return ast_->record(index_).op;
+        }
+
+        num_t get_num() const override
+        {
+            const auto& n = ast_->record(index_);
+            return n.kind == Kind::NUMBER ? ast_->literal(n.lhs) : nullptr;
+        }
+
+        void get_operands(std::vector<const ASTNode<BigNum, Base>*>& operands)
+            const override
+        {
+            const auto& n = ast_->record(index_);
+            if (n.kind == Kind::NUMBER)
+                return;
+            std::call_once(operands_built_, [this, &n]()
+            {
+                operands_[0] = std::make_unique<const FlatNode>(ast_, n.lhs);
+                if (n.kind == Kind::BINOP)
+                    operands_[1] =
+                        std::make_unique<const FlatNode>(ast_, n.rhs);
+            });
+            operands.push_back(operands_[0].get());
+            if (n.kind == Kind::BINOP)
+                operands.push_back(operands_[1].get());
+        }
+
+        void compile(Bytecode<BigNum, Base>& code) const override
+        {
+            const auto& n = ast_->record(index_);
+            if (n.kind == Kind::NUMBER)
+                code.push_literal(ast_->literal(n.lhs));
+            else if (n.kind == Kind::UNOP)
+                code.push_unop(n.op);
+            else
+                code.push_binop(n.op);
+        }
+
+        /// Index of the node in its FlatAST.
+        index_t get_index() const
+        {
+            return index_;
+        }
+
+    private:
+        std::shared_ptr<const ast_t> ast_;
+        index_t index_;
+        mutable std::once_flag operands_built_;
+        mutable std::unique_ptr<const FlatNode> operands_[2];
+    };
+
+    /**
+    ** Factory building the nodes in a FlatAST.
+    **
+    ** The operands given must have been built by this factory. The nodes
+    ** built keep the arena alive, so they stay valid after the factory.
+    **/
+    template <typename BigNum, typename Base>
+    class FlatASTFactory : public ASTFactory<BigNum, Base>
+    {
+    public:
+        /// BigNum.
+        using num_t = BigNum;
+        /// Base.
+        using base_t = Base;
+        /// Pointer to AST node.
+        using node_t = std::shared_ptr<ASTNode<BigNum, Base>>;
+        /// Arena of the nodes.
+        using ast_t = FlatAST<BigNum, Base>;
+
+        node_t operator()(const node_t& lhs, OpType op) const override
+        {
+            return view(ast_->add_unop(index(lhs), op));
+        }
+
+        node_t operator()(const node_t& lhs, const node_t& rhs,
+                          OpType op) const override
+        {
+            return view(ast_->add_binop(index(lhs), index(rhs), op));
+        }
+
+        node_t operator()(const std::shared_ptr<num_t>& num) const override
+        {
+            return view(ast_->add_number(num));
+        }
+
+        /// Arena of the nodes built.
+        const ast_t& get_ast() const
+        {
+            return *ast_;
+        }
+
+    private:
+        /// Index of \a node in the arena.
+        static typename ast_t::index_t index(const node_t& node)
+        {
+            return static_cast<const FlatNode<BigNum, Base>&>(*node)
+                .get_index();
+        }
+
+        /// View of the node \a i of the arena.
+        node_t view(typename ast_t::index_t i) const
+        {
+            return std::make_shared<FlatNode<BigNum, Base>>(ast_, i);
+        }
+
+        std::shared_ptr<ast_t> ast_ = std::make_shared<ast_t>();
+    };
+}
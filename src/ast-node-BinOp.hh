@@ -10,6 +10,7 @@
 
 #include "ast-node.hh"
 #include "ast-factory.hh"
+#include "bytecode.hh"
 
 
 namespace bistro
@@ -38,74 +39,34 @@ namespace bistro
             ,op_(op)
         {
         }
-        /// Print the tree in infix notation, e.g. "(2+3)".
-        std::ostream&
-        print_infix(std::ostream& out, const base_t& b) const
+        /// Evaluate the tree and return a shared_pointer to the result.
+        num_t eval() const
         {
-            std::cout << '(';
-            right_node_->print_infix(out, b);
-            if (op_ == OpType::MINUS)
-                out << '-';
-            if (op_ == OpType::PLUS)
-                out << '+';
-            if (op_ == OpType::DIVIDE)
-                out << '/';
-            if (op_ == OpType::TIMES)
-                out << '*';
-            right_node_->print_infix(out, b);
-            std::cout << ')';
-
-            return out;
-
+            auto right_eval = right_node_->eval();
+            auto left_eval = left_node_->eval();
+            return std::make_shared<BigNum>(apply(op_, *left_eval, *right_eval));
         }
 
-        /// Print the tree in polish notation, e.g. "+ 2 3".
-        std::ostream&
-        print_pol(std::ostream& out, const base_t& b) const
+        NodeKind get_kind() const override
         {
-            if (op_ == OpType::MINUS)
-                out << '-';
-            if (op_ == OpType::PLUS)
-                out << '+';
-            if (op_ == OpType::DIVIDE)
-                out << '/';
-            if (op_ == OpType::TIMES)
-                out << '*';
-            right_node_->print_pol(out, b);
-            right_node_->print_pol(out, b);
-            return out;
-
+            return NodeKind::BINOP;
         }
 
-        /// Print the tree in reverse polish notation, e.g. "2 3 +".
-        std::ostream&
-        print_rpol(std::ostream& out, const base_t& b) const
+        OpType get_op() const override
         {
-            if (op_ == OpType::MINUS)
-                out << '-';
-            if (op_ == OpType::PLUS)
-                out << '+';
-            right_node_->print_pol(out, b);
-            right_node_->print_pol(out, b);
-            if (op_ == OpType::MINUS)
-                out << '-';
-            if (op_ == OpType::PLUS)
-                out << '+';
-            if (op_ == OpType::DIVIDE)
-                out << '/';
-            if (op_ == OpType::TIMES)
-                out << '*';
-
-            return out;
+            return op_;
+        }
 
+        void get_operands(std::vector<const ASTNode<BigNum, Base>*>& operands)
+            const override
+        {
+            operands.push_back(left_node_.get());
+            operands.push_back(right_node_.get());
         }
 
-        /// Evaluate the tree and return a shared_pointer to the result.
-        num_t eval() const
+        void compile(Bytecode<BigNum, Base>& code) const override
         {
-            auto right_eval = right_node_->eval();
-            auto left_eval = left_node_->eval();
-            return std::make_shared<BigNum>(*(left_eval.get()) + *(right_eval.get()));
+            code.push_binop(op_);
         }
     private:
 
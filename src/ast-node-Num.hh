@@ -10,6 +10,7 @@
 
 #include "ast-node.hh"
 #include "ast-factory.hh"
+#include "bytecode.hh"
 namespace bistro
 {
     template <typename BigNum, typename Base>
@@ -36,35 +37,25 @@ namespace bistro
             : num_(num) 
         {
         }
-        /// Print the tree in infix notation, e.g. "(2+3)".
-        std::ostream&
-        print_infix(std::ostream& out, const base_t& b) const override
+        /// Evaluate the tree and return a shared_pointer to the result.
+        num_t eval() const override
         {
-            num_->print(out, b);
-            return out;
+            return num_;
         }
-        
-        /// Print the tree in polish notation, e.g. "+ 2 3".
-        std::ostream&
-        print_pol(std::ostream& out, const base_t& b) const override
+
+        NodeKind get_kind() const override
         {
-            num_->print(out, b);
-            return out;
-    
+            return NodeKind::NUMBER;
         }
-        
-        /// Print the tree in reverse polish notation, e.g. "2 3 +".
-        std::ostream&
-        print_rpol(std::ostream& out, const base_t& b) const override
+
+        num_t get_num() const override
         {
-            num_->print(out, b);
-            return out;
+            return num_;
         }
-        
-        /// Evaluate the tree and return a shared_pointer to the result.
-        num_t eval() const override
+
+        void compile(Bytecode<BigNum, Base>& code) const override
         {
-            return num_;
+            code.push_literal(num_);
         }
     private:
         num_t num_;
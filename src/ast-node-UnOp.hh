@@ -10,6 +10,7 @@
 
 #include "ast-node.hh"
 #include "ast-factory.hh"
+#include "bytecode.hh"
 
 namespace bistro
 {
@@ -38,43 +39,33 @@ namespace bistro
             ,op_(op)
         {
         }
-        /// Print the tree in infix notation, e.g. "(2+3)".
-
-        std::ostream&
-        print_infix(std::ostream& out, const base_t& b) const override
+        /// Evaluate the tree and return a shared_pointer to the result.
+        virtual num_t eval() const override
         {
             if (op_ == OpType::MINUS)
-                out << '-';
-            node_->print_infix(out, b);
-            return out;
+                return std::make_shared<BigNum>(negate(*node_->eval()));
+            return node_->eval();
         }
 
-        /// Print the tree in polish notation, e.g. "+ 2 3".
-        std::ostream&
-        print_pol(std::ostream& out, const base_t& b) const override
+        NodeKind get_kind() const override
         {
-            if (op_ == OpType::MINUS)
-                out << '-';
-            node_->print_pol(out, b);
-            return out;
-
+            return NodeKind::UNOP;
         }
 
-        /// Print the tree in reverse polish notation, e.g. "2 3 +".
-        std::ostream&
-        print_rpol(std::ostream& out, const base_t& b) const override
+        OpType get_op() const override
         {
-            node_->print_rpol(out, b);
-            if (op_ == OpType::MINUS)
-                out << '-';
-            return out;
+            return op_;
+        }
 
+        void get_operands(std::vector<const ASTNode<BigNum, Base>*>& operands)
+            const override
+        {
+            operands.push_back(node_.get());
         }
 
-        /// Evaluate the tree and return a shared_pointer to the result.
-        virtual num_t eval() const override
+        void compile(Bytecode<BigNum, Base>& code) const override
         {
-            return node_->eval();
+            code.push_unop(op_);
         }
     private:
         node_t node_;
@@ -1,6 +1,16 @@
 #pragma once
 
+#include <algorithm> // max, min
+#include <cstdint> // uint8_t
+#include <cstring> // strlen
+#include <initializer_list>
+#include <memory> // shared_ptr
 #include <ostream>
+#include <sstream> // ostringstream
+#include <string>
+#include <vector>
+
+#include "output-buffer.hh"
 //#include "base.hh"
 //#include "bignum.hh"
 
@@ -15,6 +25,130 @@ namespace bistro
         MODULO,
         POWER,
     };
+
+    /// Textual representation of \a op.
+    inline const char* op_str(OpType op)
+    {
+        switch (op)
+        {
+        case OpType::PLUS:
+            return "+";
+        case OpType::MINUS:
+            return "-";
+        case OpType::TIMES:
+            return "*";
+        case OpType::DIVIDE:
+            return "/";
+        case OpType::MODULO:
+            return "%";
+        default:
+            return "**";
+        }
+    }
+
+    /// Apply the binary operator \a op to \a lhs and \a rhs.
+    template <typename BigNum>
+    BigNum apply(OpType op, const BigNum& lhs, const BigNum& rhs)
+    {
+        switch (op)
+        {
+        case OpType::PLUS:
+            return lhs + rhs;
+        case OpType::MINUS:
+            return lhs - rhs;
+        case OpType::TIMES:
+            return lhs * rhs;
+        case OpType::DIVIDE:
+            return lhs / rhs;
+        case OpType::MODULO:
+            return lhs % rhs;
+        default:
+            return lhs.pow(rhs);
+        }
+    }
+
+    /// Return the opposite of \a num.
+    template <typename BigNum>
+    BigNum negate(const BigNum& num)
+    {
+        BigNum res = num.clone();
+        res.set_positive(!num.is_positive());
+        return res;
+    }
+
+    /**
+    ** Bound on the number of digits of the result of \a op, for operands of
+    ** \a lhs and \a rhs digits, \a exponent bounding the value of the right
+    ** operand of a POWER.
+    **/
+    inline double result_digits(OpType op, double lhs, double rhs,
+                                double exponent)
+    {
+        switch (op)
+        {
+        case OpType::PLUS:
+        case OpType::MINUS:
+            return std::max(lhs, rhs) + 1;
+        case OpType::TIMES:
+            return lhs + rhs;
+        case OpType::DIVIDE:
+            return std::max(lhs - rhs + 1, 1.);
+        case OpType::MODULO:
+            return std::min(lhs, rhs);
+        default:
+            return std::max(lhs * exponent, 1.);
+        }
+    }
+
+    /// Value of \a num, or \a cap if it is not less.
+    template <typename BigNum>
+    double value_or(const BigNum& num, double cap)
+    {
+        double res = 0;
+        for (auto i = num.get_num_digits(); i-- > 0;)
+        {
+            res = res * num.get_base_num() + num.get_digit(i);
+            if (res >= cap)
+                return cap;
+        }
+        return res;
+    }
+
+    /// Kind of node of an AST.
+    enum class NodeKind : uint8_t
+    {
+        NUMBER,
+        UNOP,
+        BINOP,
+    };
+
+    template <typename BigNum, typename Base>
+    class Bytecode;
+
+    /**
+    ** Value of a node, kept once computed, by ASTNode::eval or by a Bytecode
+    ** (see SharedNode). It is read and written concurrently.
+    **/
+    template <typename BigNum>
+    class Memo
+    {
+    public:
+        /// Value kept, nullptr if not computed yet.
+        std::shared_ptr<BigNum> get() const
+        {
+            return std::atomic_load(&value_);
+        }
+
+        /// Keep \a value.
+        void set(const std::shared_ptr<BigNum>& value)
+        {
+            std::atomic_store(&value_, value);
+        }
+
+    private:
+        std::shared_ptr<BigNum> value_;
+    };
+
     /**
     ** Abstract class ASTNode.
     **
@@ -44,24 +178,181 @@ namespace bistro
 
         /// Print the tree in infix notation, e.g. "(2+3)".
         virtual std::ostream&
-        print_infix(std::ostream& out, const base_t& b) const = 0;
+        print_infix(std::ostream& out, const base_t& b) const
+        {
+            return print(out, b, Notation::INFIX);
+        }
 
         /// Print the tree in polish notation, e.g. "+ 2 3".
         virtual std::ostream&
-        print_pol(std::ostream&, const base_t&) const
+        print_pol(std::ostream& out, const base_t& b) const
         {
-            throw "Not implemented";
+            return print(out, b, Notation::POLISH);
         }
 
         /// Print the tree in reverse polish notation, e.g. "2 3 +".
         virtual std::ostream&
-        print_rpol(std::ostream&, const base_t&) const
+        print_rpol(std::ostream& out, const base_t& b) const
         {
-            throw "Not implemented";
+            return print(out, b, Notation::REVERSE_POLISH);
         }
 
         /// Evaluate the tree and return a shared_pointer to the result.
         virtual num_t eval() const = 0;
+
+        /// Kind of the node.
+        virtual NodeKind get_kind() const = 0;
+
+        /// Operator of a UNOP or BINOP node.
+        virtual OpType get_op() const
+        {
+            return OpType::PLUS;
+        }
+
+        /// Number of a NUMBER node, nullptr for the others.
+        virtual num_t get_num() const
+        {
+            return nullptr;
+        }
+
+        /// Append the operands of the node to \a operands, from the left.
+        virtual void get_operands(std::vector<const ASTNode*>&) const
+        {
+        }
+
+        /**
+        ** Whether the node may be the operand of several nodes, and then
+        ** should be evaluated once (see SharedASTFactory).
+        **/
+        virtual bool is_shared() const
+        {
+            return false;
+        }
+
+        /// Mark the node as the operand of one more node, if it may be shared.
+        virtual void share() const
+        {
+        }
+
+        /**
+        ** Cell keeping the value of a shared node, which keeps the node
+        ** alive, nullptr for the other nodes.
+        **/
+        virtual std::shared_ptr<Memo<BigNum>> get_memo() const
+        {
+            return nullptr;
+        }
+
+        /**
+        ** Append the instructions of the node to \a code, those of its
+        ** operands being already appended (see Bytecode::compile).
+        **/
+        virtual void compile(Bytecode<BigNum, Base>& code) const = 0;
+
+    private:
+        /// Notation of a printed tree.
+        enum class Notation
+        {
+            INFIX,
+            POLISH,
+            REVERSE_POLISH,
+        };
+
+        /**
+        ** Print the tree in \a notation, through a single buffer. A negative
+        ** number or operand is written "-x" in infix notation, "- 0 x" in
+        ** polish notation and "0 x -" in reverse polish notation.
+        **
+        ** The tree is walked with an explicit stack of the nodes and the
+        ** texts left to print, so that deep trees do not overflow the call
+        ** stack.
+        **/
+        std::ostream& print(std::ostream& out, const base_t& b,
+                            Notation notation) const
+        {
+            std::ostringstream zero_repr;
+            zero_repr << b.get_digit_representation(0);
+            const std::string zero = zero_repr.str();
+
+            // A node to print, or a text if null.
+            struct Item
+            {
+                const ASTNode* node;
+                const char* text;
+            };
+            std::vector<Item> todo = {{this, nullptr}};
+            auto push = [&todo](std::initializer_list<Item> items)
+            {
+                for (auto it = items.end(); it != items.begin();)
+                    todo.push_back(*--it);
+            };
+            auto text = [](const char* str) { return Item{nullptr, str}; };
+            auto node = [](const ASTNode* n) { return Item{n, nullptr}; };
+            std::vector<const ASTNode*> operands;
+            {
+                OutputBuffer buf(out);
+                while (!todo.empty())
+                {
+                    Item item = todo.back();
+                    todo.pop_back();
+                    if (!item.node)
+                    {
+                        buf.write(item.text, std::strlen(item.text));
+                        continue;
+                    }
+                    operands.clear();
+                    item.node->get_operands(operands);
+                    switch (item.node->get_kind())
+                    {
+                    case NodeKind::NUMBER:
+                    {
+                        auto ptr = item.node->get_num();
+                        const BigNum& num = *ptr;
+                        bool negative = !num.is_positive() && num;
+                        if (negative && notation == Notation::INFIX)
+                            buf.put('-');
+                        else if (negative)
+                        {
+                            if (notation == Notation::POLISH)
+                                buf.write("- ", 2);
+                            buf.write(zero.data(), zero.size());
+                            buf.put(' ');
+                        }
+                        num.print_digits(buf, b);
+                        if (negative && notation == Notation::REVERSE_POLISH)
+                            buf.write(" -", 2);
+                        break;
+                    }
+                    case NodeKind::UNOP:
+                        if (item.node->get_op() != OpType::MINUS)
+                            push({node(operands[0])});
+                        else if (notation == Notation::INFIX)
+                            push({text("-"), node(operands[0])});
+                        else if (notation == Notation::POLISH)
+                            push({text("- "), text(zero.c_str()), text(" "),
+                                  node(operands[0])});
+                        else
+                            push({text(zero.c_str()), text(" "),
+                                  node(operands[0]), text(" -")});
+                        break;
+                    default:
+                    {
+                        const char* op = op_str(item.node->get_op());
+                        if (notation == Notation::INFIX)
+                            push({text("("), node(operands[0]), text(op),
+                                  node(operands[1]), text(")")});
+                        else if (notation == Notation::POLISH)
+                            push({text(op), text(" "), node(operands[0]),
+                                  text(" "), node(operands[1])});
+                        else
+                            push({node(operands[0]), text(" "),
+                                  node(operands[1]), text(" "), text(op)});
+                    }
+                    }
+                }
+            }
+            return out;
+        }
     };
     
 }
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm> // push_heap, pop_heap
+#include <utility> // move, pair
+#include <vector>
+
+#include "ast-rewrite.hh"
+
+namespace bistro
+{
+    /**
+    ** Pass reassociating the chains of additions and of multiplications.
+    **
+    ** The parsers build left-deep trees: a product of n numbers multiplies
+    ** a growing accumulator by each of them in turn. Each chain of + and -,
+    ** or of *, is flattened, and rebuilt as a balanced tree: the terms of a
+    ** sum are added pairwise, the positive ones apart from the negative
+    ** ones, and the factors of a product are multiplied two smallest first,
+    ** as in a product tree, so that the large products have operands of
+    ** similar size.
+    **
+    ** A chain stops at the shared nodes, which are rebuilt once.
+    **/
+    template <typename BigNum, typename Base>
+    class Rebalancer : public ASTRewriter<BigNum, Base>
+    {
+    public:
+        using super_t = ASTRewriter<BigNum, Base>;
+        using typename super_t::ast_t;
+        using typename super_t::factory_t;
+        using typename super_t::Rewritten;
+
+        /// Pass building the new nodes with \a fact.
+        explicit Rebalancer(const factory_t& fact)
+            : super_t(fact)
+        {
+        }
+
+    protected:
+        void get_operands(const ast_t& node,
+                          std::vector<const ast_t*>& operands) override
+        {
+            if (!is_chain(node))
+                return node.get_operands(operands);
+            flatten(node, operands, nullptr);
+        }
+
+        Rewritten build(const ast_t& node,
+                        std::vector<Rewritten>& operands) override
+        {
+            if (!is_chain(node))
+                return super_t::build(node, operands);
+            if (node.get_op() == OpType::TIMES)
+                return product(operands);
+
+            // The terms of a sum, then those subtracted.
+            std::vector<const ast_t*> terms;
+            std::vector<bool> negative;
+            flatten(node, terms, &negative);
+            std::vector<Rewritten> pos;
+            std::vector<Rewritten> neg;
+            for (size_t i = 0; i < operands.size(); i++)
+                (negative[i] ? neg : pos).push_back(std::move(operands[i]));
+            // The leftmost term is never subtracted.
+            Rewritten res = sum(pos);
+            if (neg.empty())
+                return res;
+            return this->make_binop(std::move(res), sum(neg), OpType::MINUS);
+        }
+
+    private:
+        /// Family of the operator \a op: + and - are reassociated together.
+        static OpType family(OpType op)
+        {
+            return op == OpType::MINUS ? OpType::PLUS : op;
+        }
+
+        /// Whether \a node is the root of a chain.
+        static bool is_chain(const ast_t& node)
+        {
+            return node.get_kind() == NodeKind::BINOP
+                && (family(node.get_op()) == OpType::PLUS
+                    || node.get_op() == OpType::TIMES);
+        }
+
+        /**
+        ** Append to \a operands the operands of the chain of root \a root,
+        ** from the left, and to \a negative, if not null, whether each one is
+        ** subtracted.
+        **/
+        static void flatten(const ast_t& root,
+                            std::vector<const ast_t*>& operands,
+                            std::vector<bool>* negative)
+        {
+            OpType op = family(root.get_op());
+            std::vector<std::pair<const ast_t*, bool>> todo = {{&root, false}};
+            std::vector<const ast_t*> children;
+            while (!todo.empty())
+            {
+                auto [node, neg] = todo.back();
+                todo.pop_back();
+                if (node != &root
+                    && (node->get_kind() != NodeKind::BINOP
+                        || family(node->get_op()) != op
+                        || node->is_shared()))
+                {
+                    operands.push_back(node);
+                    if (negative)
+                        negative->push_back(neg);
+                    continue;
+                }
+                children.clear();
+                node->get_operands(children);
+                todo.emplace_back(children[1],
+                                  neg != (node->get_op() == OpType::MINUS));
+                todo.emplace_back(children[0], neg);
+            }
+        }
+
+        /// Sum of \a terms, added pairwise.
+        Rewritten sum(std::vector<Rewritten>& terms) const
+        {
+            while (terms.size() > 1)
+            {
+                size_t n = 0;
+                for (size_t i = 0; i + 1 < terms.size(); i += 2)
+                    terms[n++] = this->make_binop(std::move(terms[i]),
+                                                  std::move(terms[i + 1]),
+                                                  OpType::PLUS);
+                if (terms.size() % 2)
+                    terms[n++] = std::move(terms.back());
+                terms.resize(n);
+            }
+            return std::move(terms[0]);
+        }
+
+        /// Product of \a factors, the two smallest first.
+        Rewritten product(std::vector<Rewritten>& factors) const
+        {
+            auto larger = [](const Rewritten& a, const Rewritten& b)
+            {
+                return a.size > b.size;
+            };
+            std::make_heap(factors.begin(), factors.end(), larger);
+            while (factors.size() > 1)
+            {
+                std::pop_heap(factors.begin(), factors.end(), larger);
+                Rewritten a = std::move(factors.back());
+                factors.pop_back();
+                std::pop_heap(factors.begin(), factors.end(), larger);
+                Rewritten b = std::move(factors.back());
+                factors.pop_back();
+                factors.push_back(this->make_binop(std::move(a), std::move(b),
+                                                   OpType::TIMES));
+                std::push_heap(factors.begin(), factors.end(), larger);
+            }
+            return std::move(factors[0]);
+        }
+    };
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <algorithm> // max
+#include <cstdint> // uint32_t
+#include <memory> // shared_ptr
+#include <unordered_map>
+#include <utility> // move
+#include <vector>
+
+#include "ast-node.hh"
+#include "ast-factory.hh"
+
+namespace bistro
+{
+    /**
+    ** Pass rebuilding an AST with a factory.
+    **
+    ** The nodes are rebuilt in post-order, each one from the rebuilt
+    ** operands given by get_operands, by build: by default, both copy the
+    ** node. A derived pass overrides them to rewrite the tree. Along with
+    ** each rebuilt node go an estimate of the number of digits of its value,
+    ** to guide the rewriting, and whether its evaluation may throw, which a
+    ** rewriting must not hide.
+    **
+    ** A shared node (see ASTNode::is_shared) is rebuilt once, and its
+    ** rebuilding is shared as well. The AST is walked with an explicit
+    ** stack, so that deep trees do not overflow the call stack.
+    **/
+    template <typename BigNum, typename Base>
+    class ASTRewriter
+    {
+    public:
+        /// Shared_ptr to a BigNum.
+        using num_t = std::shared_ptr<BigNum>;
+        /// AST node.
+        using ast_t = ASTNode<BigNum, Base>;
+        /// Pointer to AST node.
+        using node_t = std::shared_ptr<ast_t>;
+        /// Factory building the new nodes.
+        using factory_t = ASTFactory<BigNum, Base>;
+
+        /**
+        ** A rebuilt node, the estimated number of digits of its value, and
+        ** whether it may throw, e.g. for a division by 0.
+        **/
+        struct Rewritten
+        {
+            node_t node;
+            double size;
+            bool may_throw;
+        };
+
+        /// Pass building the new nodes with \a fact.
+        explicit ASTRewriter(const factory_t& fact)
+            : fact_(fact)
+        {
+        }
+
+        virtual ~ASTRewriter() = default;
+
+        /// Rebuild \a ast.
+        node_t operator()(const ast_t& ast)
+        {
+            return rewrite(ast).node;
+        }
+
+        /// Rebuild \a ast, along with what is known of its value.
+        Rewritten rewrite(const ast_t& ast)
+        {
+            // Nodes to visit, and their number of operands once visited.
+            std::vector<std::pair<const ast_t*, uint32_t>> todo = {
+                {&ast, unvisited}};
+            std::vector<Rewritten> values;
+            std::vector<Rewritten> args;
+            std::vector<const ast_t*> operands;
+            while (!todo.empty())
+            {
+                auto [node, count] = todo.back();
+                todo.pop_back();
+                if (count == unvisited)
+                {
+                    if (node->is_shared())
+                    {
+                        auto it = shared_.find(node);
+                        if (it != shared_.end())
+                        {
+                            it->second.node->share();
+                            values.push_back(it->second);
+                            continue;
+                        }
+                    }
+                    operands.clear();
+                    get_operands(*node, operands);
+                    todo.emplace_back(node, operands.size());
+                    for (auto it = operands.rbegin(); it != operands.rend();
+                         ++it)
+                        todo.emplace_back(*it, unvisited);
+                    continue;
+                }
+
+                args.clear();
+                for (auto it = values.end() - count; it != values.end(); ++it)
+                    args.push_back(std::move(*it));
+                values.resize(values.size() - count);
+                values.push_back(build(*node, args));
+                if (node->is_shared())
+                    shared_.emplace(node, values.back());
+            }
+            return values.back();
+        }
+
+    protected:
+        /**
+        ** Append to \a operands the nodes to rebuild before \a node, from the
+        ** left: by default, its operands.
+        **/
+        virtual void get_operands(const ast_t& node,
+                                  std::vector<const ast_t*>& operands)
+        {
+            node.get_operands(operands);
+        }
+
+        /// Rebuild \a node from the rebuilt \a operands: by default, copy it.
+        virtual Rewritten build(const ast_t& node,
+                                std::vector<Rewritten>& operands)
+        {
+            switch (node.get_kind())
+            {
+            case NodeKind::NUMBER:
+                return make_number(node.get_num());
+            case NodeKind::UNOP:
+                return make_unop(std::move(operands[0]), node.get_op());
+            default:
+                return make_binop(std::move(operands[0]),
+                                  std::move(operands[1]), node.get_op());
+            }
+        }
+
+        /// Build a node for \a num.
+        Rewritten make_number(const num_t& num) const
+        {
+            return {fact_(num), std::max<double>(num->get_num_digits(), 1),
+                    false};
+        }
+
+        /// Build the unary operation \a op on \a operand.
+        Rewritten make_unop(Rewritten operand, OpType op) const
+        {
+            return {fact_(operand.node, op), operand.size,
+                    operand.may_throw};
+        }
+
+        /**
+        ** Build the binary operation \a op on \a lhs and \a rhs. An
+        ** exponent that is not a literal is estimated to be large.
+        **/
+        Rewritten make_binop(Rewritten lhs, Rewritten rhs, OpType op) const
+        {
+            bool literal = rhs.node->get_kind() == NodeKind::NUMBER;
+            double exponent = literal ? value_or(*rhs.node->get_num(), unknown)
+                                      : unknown;
+            double size = result_digits(op, lhs.size, rhs.size, exponent);
+            bool may_throw = lhs.may_throw || rhs.may_throw;
+            if (op == OpType::DIVIDE || op == OpType::MODULO)
+                may_throw |= !is_nonzero(*rhs.node);
+            // A literal exponent is not negative.
+            if (op == OpType::POWER)
+                may_throw |= !literal;
+            return {fact_(lhs.node, rhs.node, op), size, may_throw};
+        }
+
+        /// Whether \a node is a number other than 0.
+        static bool is_nonzero(const ast_t& node)
+        {
+            return node.get_kind() == NodeKind::NUMBER && *node.get_num();
+        }
+
+        /// Factory building the new nodes.
+        const factory_t& fact_;
+
+    private:
+        /// Number of operands of a node not visited yet.
+        static constexpr uint32_t unvisited = uint32_t(-1);
+
+        /// Estimated value of an exponent that is not a small number.
+        static constexpr double unknown = 1 << 20;
+
+        /// Rebuilt shared nodes.
+        std::unordered_map<const ast_t*, Rewritten> shared_;
+    };
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef> // size_t
+#include <functional> // hash
+#include <memory> // shared_ptr
+#include <mutex>
+#include <unordered_map>
+#include <utility> // forward
+
+#include "ast-node.hh"
+#include "ast-factory.hh"
+
+namespace bistro
+{
+    /**
+    ** Node built by a SharedASTFactory.
+    **
+    ** Once the node is the operand of several nodes, its value is kept the
+    ** first time it is evaluated, and returned by the next evaluations, by
+    ** eval or by a Bytecode.
+    **/
+    template <typename Node>
+    class SharedNode : public Node,
+                       public std::enable_shared_from_this<SharedNode<Node>>
+    {
+    public:
+        /// Shared_ptr to a BigNum.
+        using num_t = typename Node::num_t;
+        /// Cell keeping the value.
+        using memo_t = Memo<typename Node::bignum_t>;
+
+        using Node::Node;
+
+        num_t eval() const override
+        {
+            if (!shared_)
+                return Node::eval();
+            if (auto value = memo_.get())
+                return value;
+            auto value = Node::eval();
+            memo_.set(value);
+            return value;
+        }
+
+        bool is_shared() const override
+        {
+            return shared_;
+        }
+
+        void share() const override
+        {
+            shared_ = true;
+        }
+
+        std::shared_ptr<memo_t> get_memo() const override
+        {
+            if (!shared_)
+                return nullptr;
+            return std::shared_ptr<memo_t>(this->shared_from_this(), &memo_);
+        }
+
+    private:
+        mutable std::atomic<bool> shared_ = false;
+        mutable memo_t memo_;
+    };
+
+    /**
+    ** Factory building each distinct subtree once (hash-consing).
+    **
+    ** Equal numbers, and operations on the same operands, give the same
+    ** node: an expression repeating a subexpression becomes a DAG, where the
+    ** subexpression is evaluated once, by eval or by a Bytecode.
+    **
+    ** The factory keeps all the nodes it built.
+    **/
+    template <typename BigNum, typename Base>
+    class SharedASTFactory : public ASTFactory<BigNum, Base>
+    {
+    public:
+        /// BigNum.
+        using num_t = BigNum;
+        /// Base.
+        using base_t = Base;
+        /// Pointer to AST node.
+        using node_t = std::shared_ptr<ASTNode<BigNum, Base>>;
+
+        node_t operator()(const node_t& lhs, OpType op) const override
+        {
+            return get(unops_, {lhs.get(), nullptr, op}, lhs, op);
+        }
+
+        node_t operator()(const node_t& lhs, const node_t& rhs,
+                          OpType op) const override
+        {
+            return get(binops_, {lhs.get(), rhs.get(), op}, lhs, rhs, op);
+        }
+
+        node_t operator()(const std::shared_ptr<num_t>& num) const override
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto [it, fresh] = numbers_.try_emplace(num.get());
+            if (fresh)
+                it->second = std::make_shared<NumberNode<BigNum, Base>>(num);
+            return it->second;
+        }
+
+    private:
+        /// Operation on operands.
+        struct Key
+        {
+            const void* lhs;
+            const void* rhs;
+            OpType op;
+
+            bool operator==(const Key& other) const
+            {
+                return lhs == other.lhs && rhs == other.rhs && op == other.op;
+            }
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key& key) const
+            {
+                std::hash<const void*> h;
+                size_t res = h(key.lhs) * 31 + h(key.rhs);
+                return res * 31 + static_cast<size_t>(key.op);
+            }
+        };
+
+        /**
+        ** Hash of the digits and sign of a number. The sign of 0 is left
+        ** out, as -0 equals 0.
+        **/
+        struct NumHash
+        {
+            size_t operator()(const num_t* num) const
+            {
+                size_t res = 0;
+                for (auto i = num->get_num_digits(); i-- > 0;)
+                    res = res * 1000003 + num->get_digit(i);
+                return res && !num->is_positive() ? ~res : res;
+            }
+        };
+
+        struct NumEqual
+        {
+            bool operator()(const num_t* lhs, const num_t* rhs) const
+            {
+                return *lhs == *rhs;
+            }
+        };
+
+        /// Nodes of type \a Node, by operation.
+        template <typename Node>
+        using table_t = std::unordered_map<Key,
+                                           std::shared_ptr<SharedNode<Node>>,
+                                           KeyHash>;
+
+        /**
+        ** Node of \a key in \a table, built from \a args if new, and marked
+        ** as shared otherwise.
+        **/
+        template <typename Node, typename... Args>
+        node_t get(table_t<Node>& table, const Key& key, Args&&... args) const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto [it, fresh] = table.try_emplace(key);
+            if (fresh)
+                it->second = std::make_shared<SharedNode<Node>>(
+                    std::forward<Args>(args)...);
+            else
+                it->second->share();
+            return it->second;
+        }
+
+        mutable std::mutex mutex_;
+        mutable std::unordered_map<const num_t*, node_t, NumHash, NumEqual>
+            numbers_;
+        mutable table_t<UnOpNode<BigNum, Base>> unops_;
+        mutable table_t<BinOpNode<BigNum, Base>> binops_;
+    };
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <memory> // shared_ptr
+#include <utility> // move
+#include <vector>
+
+#include "ast-rewrite.hh"
+
+namespace bistro
+{
+    /**
+    ** Pass applying cheap algebraic identities before evaluating.
+    **
+    ** The neutral operands are dropped (x+0, x-0, x*1, x/1, x**1), the
+    ** absorbing ones give their value (x*0, x**0, x%1, 0/x, 0**x), double
+    ** negations cancel out, and x-x gives 0 when both operands are the same
+    ** node, as built by a SharedASTFactory.
+    **
+    ** An operand whose evaluation may throw is not dropped: 0/x is only
+    ** simplified for a literal x, and x*0 is kept if x divides by 0.
+    **/
+    template <typename BigNum, typename Base>
+    class Simplifier : public ASTRewriter<BigNum, Base>
+    {
+    public:
+        using super_t = ASTRewriter<BigNum, Base>;
+        using typename super_t::num_t;
+        using typename super_t::ast_t;
+        using typename super_t::factory_t;
+        using typename super_t::Rewritten;
+
+        /// Pass building the new nodes with \a fact, for numbers in \a base.
+        Simplifier(const factory_t& fact, const Base& base)
+            : super_t(fact)
+            , zero_(std::make_shared<BigNum>(base.get_base_num()))
+        {
+            // 1 has no digit in base 1, where x**0 is left to the evaluation.
+            if (base.get_base_num() < 2)
+                return;
+            one_ = std::make_shared<BigNum>(base.get_base_num());
+            one_->set_digit(0, 1);
+        }
+
+    protected:
+        /// The operand of a chain of unary operators is rebuilt directly.
+        void get_operands(const ast_t& node,
+                          std::vector<const ast_t*>& operands) override
+        {
+            if (node.get_kind() != NodeKind::UNOP)
+                return node.get_operands(operands);
+            const ast_t* operand;
+            negative(node, operand);
+            operands.push_back(operand);
+        }
+
+        Rewritten build(const ast_t& node,
+                        std::vector<Rewritten>& operands) override
+        {
+            switch (node.get_kind())
+            {
+            case NodeKind::NUMBER:
+                return super_t::build(node, operands);
+            case NodeKind::UNOP:
+            {
+                const ast_t* operand;
+                return negate(std::move(operands[0]),
+                              negative(node, operand));
+            }
+            default:
+                return simplify(std::move(operands[0]),
+                                std::move(operands[1]), node.get_op());
+            }
+        }
+
+    private:
+        /**
+        ** Whether the chain of unary operators of root \a node negates its
+        ** operand, which is stored in \a operand. The chain stops at the
+        ** shared nodes.
+        **/
+        static bool negative(const ast_t& node, const ast_t*& operand)
+        {
+            bool res = false;
+            std::vector<const ast_t*> operands;
+            operand = &node;
+            while (operand->get_kind() == NodeKind::UNOP
+                   && (operand == &node || !operand->is_shared()))
+            {
+                res ^= operand->get_op() == OpType::MINUS;
+                operands.clear();
+                operand->get_operands(operands);
+                operand = operands[0];
+            }
+            return res;
+        }
+
+        /// \a operand, negated if \a neg.
+        Rewritten negate(Rewritten operand, bool neg) const
+        {
+            if (!neg || is(operand, 0))
+                return operand;
+            return this->make_unop(std::move(operand), OpType::MINUS);
+        }
+
+        /// The operation \a op on \a lhs and \a rhs, simplified.
+        Rewritten simplify(Rewritten lhs, Rewritten rhs, OpType op) const
+        {
+            switch (op)
+            {
+            case OpType::PLUS:
+                if (is(lhs, 0))
+                    return rhs;
+                if (is(rhs, 0))
+                    return lhs;
+                break;
+            case OpType::MINUS:
+                if (is(rhs, 0))
+                    return lhs;
+                if (is(lhs, 0))
+                    return negate(std::move(rhs), true);
+                if (lhs.node == rhs.node && !lhs.may_throw)
+                    return this->make_number(zero_);
+                break;
+            case OpType::TIMES:
+                if (is(lhs, 0) && !rhs.may_throw)
+                    return lhs;
+                if (is(rhs, 0) && !lhs.may_throw)
+                    return rhs;
+                if (is(lhs, 1))
+                    return rhs;
+                if (is(rhs, 1))
+                    return lhs;
+                break;
+            case OpType::DIVIDE:
+                if (is(rhs, 1))
+                    return lhs;
+                if (is(lhs, 0) && this->is_nonzero(*rhs.node))
+                    return lhs;
+                break;
+            case OpType::MODULO:
+                if (is(rhs, 1) && !lhs.may_throw)
+                    return this->make_number(zero_);
+                if (is(lhs, 0) && this->is_nonzero(*rhs.node))
+                    return lhs;
+                break;
+            default:
+                if (is(rhs, 0) && !lhs.may_throw && one_)
+                    return this->make_number(one_);
+                if (is(rhs, 1))
+                    return lhs;
+                // A literal exponent is not negative.
+                if (is(lhs, 1) && rhs.node->get_kind() == NodeKind::NUMBER)
+                    return lhs;
+                if (is(lhs, 0) && this->is_nonzero(*rhs.node))
+                    return lhs;
+            }
+            return this->make_binop(std::move(lhs), std::move(rhs), op);
+        }
+
+        /// Whether \a operand is the number \a value, 0 or 1.
+        static bool is(const Rewritten& operand, unsigned value)
+        {
+            if (operand.node->get_kind() != NodeKind::NUMBER)
+                return false;
+            const BigNum& num = *operand.node->get_num();
+            for (auto i = num.get_num_digits(); i-- > 0;)
+                if (num.get_digit(i) != (i ? 0u : value))
+                    return false;
+            // 0 may have no digits.
+            return value == 0 || (num.get_num_digits() && num.is_positive());
+        }
+
+        num_t zero_;
+        /// 1, nullptr in base 1.
+        num_t one_;
+    };
+}
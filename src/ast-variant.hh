@@ -0,0 +1,227 @@
+#pragma once
+
+#include <cstdint> // uint32_t
+#include <limits>
+#include <memory> // shared_ptr
+#include <stdexcept> // length_error
+#include <type_traits> // decay_t, is_same_v
+#include <unordered_map>
+#include <utility> // pair
+#include <variant>
+#include <vector>
+
+#include "ast-node.hh"
+
+namespace bistro
+{
+    /**
+    ** AST whose nodes are the alternatives of a std::variant, without
+    ** virtual methods.
+    **
+    ** The nodes are stored by value in a single vector, and refer to their
+    ** operands and literals by 32-bit indices: a node takes 16 bytes. They
+    ** are dispatched on with std::visit, which the compiler may inline,
+    ** unlike the virtual methods of ASTNode.
+    **/
+    template <typename BigNum, typename Base>
+    class VariantAST
+    {
+    public:
+        /// Shared_ptr to a BigNum.
+        using num_t = std::shared_ptr<BigNum>;
+
+        /// AST node of the virtual hierarchy.
+        using ast_t = ASTNode<BigNum, Base>;
+
+        /// Index of a node.
+        using index_t = uint32_t;
+
+        /// Node of a number, the literal \a lhs.
+        struct NumberNode
+        {
+            index_t lhs;
+        };
+
+        /// Node of the unary operation \a op on the node \a lhs.
+        struct UnOpNode
+        {
+            index_t lhs;
+            OpType op;
+        };
+
+        /// Node of the binary operation \a op on the nodes \a lhs and \a rhs.
+        struct BinOpNode
+        {
+            index_t lhs;
+            index_t rhs;
+            OpType op;
+        };
+
+        /// Node of the AST.
+        using node_t = std::variant<NumberNode, UnOpNode, BinOpNode>;
+
+        /// Add a node for the number \a num.
+        index_t add_number(const num_t& num)
+        {
+            literals_.push_back(num);
+            return add(NumberNode{index_t(literals_.size() - 1)});
+        }
+
+        /// Add a node for the unary operation \a op on the node \a lhs.
+        index_t add_unop(index_t lhs, OpType op)
+        {
+            return add(UnOpNode{lhs, op});
+        }
+
+        /// Add a node for the binary operation \a op on \a lhs and \a rhs.
+        index_t add_binop(index_t lhs, index_t rhs, OpType op)
+        {
+            return add(BinOpNode{lhs, rhs, op});
+        }
+
+        /**
+        ** Add the nodes of \a ast, and return the index of its root. A shared
+        ** node (see ASTNode::is_shared) is added once.
+        **
+        ** The AST is walked with an explicit stack, so that deep trees do not
+        ** overflow the call stack.
+        **/
+        index_t add_tree(const ast_t& ast)
+        {
+            std::unordered_map<const ast_t*, index_t> shared;
+            // Nodes to visit, and whether their operands are added.
+            std::vector<std::pair<const ast_t*, bool>> todo = {{&ast, false}};
+            std::vector<index_t> added;
+            std::vector<const ast_t*> operands;
+            while (!todo.empty())
+            {
+                auto [node, ready] = todo.back();
+                todo.pop_back();
+                if (!ready && node->is_shared())
+                {
+                    auto it = shared.find(node);
+                    if (it != shared.end())
+                    {
+                        added.push_back(it->second);
+                        continue;
+                    }
+                }
+                if (!ready && node->get_kind() != NodeKind::NUMBER)
+                {
+                    todo.emplace_back(node, true);
+                    operands.clear();
+                    node->get_operands(operands);
+                    for (auto it = operands.rbegin(); it != operands.rend();
+                         ++it)
+                        todo.emplace_back(*it, false);
+                    continue;
+                }
+
+                index_t i;
+                switch (node->get_kind())
+                {
+                case NodeKind::NUMBER:
+                    i = add_number(node->get_num());
+                    break;
+                case NodeKind::UNOP:
+                    i = add_unop(added.back(), node->get_op());
+                    added.pop_back();
+                    break;
+                default:
+                    i = add_binop(added.end()[-2], added.back(),
+                                  node->get_op());
+                    added.pop_back();
+                    added.pop_back();
+                }
+                added.push_back(i);
+                if (node->is_shared())
+                    shared.emplace(node, i);
+            }
+            return added.back();
+        }
+
+        /// Get the node \a i.
+        const node_t& node(index_t i) const
+        {
+            return nodes_[i];
+        }
+
+        /// Number of nodes.
+        index_t size() const
+        {
+            return nodes_.size();
+        }
+
+        /**
+        ** Evaluate the tree of root \a root.
+        **
+        ** The tree is walked in post-order with an explicit stack, so that
+        ** deep trees do not overflow the call stack. The values computed are
+        ** only referenced by the stack, so sums and negations update them in
+        ** place.
+        **/
+        num_t eval(index_t root) const
+        {
+            // Nodes to visit, and whether their operands are evaluated.
+            std::vector<std::pair<index_t, bool>> todo = {{root, false}};
+            std::vector<num_t> values;
+            while (!todo.empty())
+            {
+                index_t i = todo.back().first;
+                bool ready = todo.back().second;
+                todo.pop_back();
+                std::visit([&](const auto& n)
+                {
+                    using node_type = std::decay_t<decltype(n)>;
+                    if constexpr (std::is_same_v<node_type, NumberNode>)
+                        values.push_back(literals_[n.lhs]);
+                    else if (!ready)
+                    {
+                        todo.emplace_back(i, true);
+                        if constexpr (std::is_same_v<node_type, BinOpNode>)
+                            todo.emplace_back(n.rhs, false);
+                        todo.emplace_back(n.lhs, false);
+                    }
+                    else if constexpr (std::is_same_v<node_type, UnOpNode>)
+                    {
+                        num_t& operand = values.back();
+                        if (n.op != OpType::MINUS)
+                            return;
+                        if (operand.use_count() == 1)
+                            operand->set_positive(!operand->is_positive());
+                        else
+                            operand = std::make_shared<BigNum>(
+                                negate(*operand));
+                    }
+                    else
+                    {
+                        num_t rhs = std::move(values.back());
+                        values.pop_back();
+                        num_t& lhs = values.back();
+                        if (n.op == OpType::PLUS && lhs.use_count() == 1)
+                            *lhs += *rhs;
+                        else if (n.op == OpType::MINUS
+                                 && lhs.use_count() == 1)
+                            *lhs -= *rhs;
+                        else
+                            lhs = std::make_shared<BigNum>(
+                                apply(n.op, *lhs, *rhs));
+                    }
+                }, nodes_[i]);
+            }
+            return values.back();
+        }
+
+    private:
+        index_t add(const node_t& node)
+        {
+            if (nodes_.size() == std::numeric_limits<index_t>::max())
+                throw std::length_error("le in VariantAST");
+            nodes_.push_back(node);
+            return nodes_.size() - 1;
+        }
+
+        std::vector<node_t> nodes_;
+        std::vector<num_t> literals_;
+    };
+}
@@ -2,9 +2,12 @@
 
 #include <cstdint>
 #include <initializer_list>
+#include <limits>
+#include <type_traits>
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <stdexcept>
 
 namespace bistro
 {
@@ -14,6 +17,9 @@ namespace bistro
     ** This class represents a numerical base, along with the means to convert
     ** single digits to and from textual representation.
     **
+    ** When \a Char is a byte, the value of each representation is kept in a
+    ** table, so converting a digit to its value is a single lookup.
+    **
     ** A valid representation type (for \a Char) has the following properties:
     **   - it can be copied.
     **   - it can be output (with \c operator<< )
@@ -38,6 +44,9 @@ namespace bistro
         {
             repr_.assign(list.begin(), list.end());
             base_ = repr_.size();
+            if constexpr (is_byte)
+                for (value_t i = 0; i < repr_.size(); i++)
+                    values_[index(repr_[i])] = i;
         }
 
 
@@ -57,16 +66,23 @@ namespace bistro
         **/
         void add_digit(char_t repr)
         {
-            if (!is_digit(repr))
-                repr_.push_back(repr);
-            throw std::invalid_argument("Already in the list");
+            if (is_operator(repr))
+                throw std::invalid_argument("Reserved for an operator");
+            if (is_digit(repr))
+                throw std::invalid_argument("Already in the list");
+            if constexpr (is_byte)
+                values_[index(repr)] = repr_.size();
+            repr_.push_back(repr);
+            base_ = repr_.size();
         }
 
         /// Check wether there is a match for the character representation \a c.
         bool is_digit(char_t c) const
         {
-            return std::find(repr_.begin(), repr_.end(), c) != repr_.end();
-
+            if constexpr (is_byte)
+                return values_[index(c)] != no_value;
+            else
+                return std::find(repr_.begin(), repr_.end(), c) != repr_.end();
         }
 
         /**
@@ -96,6 +112,13 @@ namespace bistro
         **/
         value_t get_char_value(char_t r) const
         {
+            if constexpr (is_byte)
+            {
+                value_t v = values_[index(r)];
+                if (v == no_value)
+                    throw std::out_of_range("oor in get_char_value");
+                return v;
+            }
             //auto it = std::find(repr_.begin(), repr_.end(), r);
             for (value_t i = 0; i < repr_.size(); i++)
             {
@@ -108,8 +131,24 @@ namespace bistro
 
 
     private:
+        /// Whether the representations are bytes, indexing values_.
+        static constexpr bool is_byte = std::is_integral_v<char_t>
+                                        && sizeof(char_t) == 1;
+
+        /// Value of the representations without a digit, in values_.
+        static constexpr value_t no_value = std::numeric_limits<value_t>::max();
+
+        /// Index of \a c in values_.
+        static std::size_t index(char_t c)
+        {
+            return static_cast<unsigned char>(c);
+        }
+
         std::vector<char_t> repr_;
-        value_t base_;
+        /// Value of each byte representation, or no_value.
+        std::vector<value_t> values_ = std::vector<value_t>(is_byte ? 256 : 0,
+                                                            no_value);
+        size_t base_ = 0;
     };
 
 }
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>  // uintptr_t
+#include <cstring>  // memcpy
+#include <stdexcept>
+
+#include "bignum.hh"
+
+namespace bistro
+{
+
+    /**
+    ** Read-only view of a BigNum in binary form, see BigNum::save.
+    **
+    ** The view reads the limbs where they are, typically in a mapped file:
+    ** nothing is copied, and only the pages holding the digits read are
+    ** loaded. The memory must outlive the view.
+    **
+    ** Unlike BigNum::load, the view doesn't check every digit, which would
+    ** read the whole number, and doesn't read the numbers saved on a host of
+    ** another byte order, whose limbs would need swapping.
+    */
+    template <typename T = uint8_t, std::size_t Radix = 0>
+    class BigNumView
+    {
+    public:
+        /// Type of the number viewed.
+        using num_t = BigNum<T, Radix>;
+
+        /// Type of a single digit.
+        using digit_t = typename num_t::digit_t;
+
+        /// Type used as index.
+        using index_t = typename num_t::index_t;
+
+        /**
+        ** View the number saved in the \a size bytes at \a data, which must
+        ** be aligned on a limb.
+        **
+        ** \throw std::invalid_argument if \a data is not aligned, if the
+        ** header doesn't describe a BigNum of this type in the byte order of
+        ** the host, or if the leading limb is zero.
+        ** \throw std::length_error if the data is truncated.
+        **/
+        BigNumView(const void* data, std::size_t size)
+        {
+            if (reinterpret_cast<std::uintptr_t>(data) % alignof(elt_t))
+                throw std::invalid_argument("ia in BigNumView");
+            BigNumHeader header;
+            if (size < sizeof(header))
+                throw std::length_error("le in BigNumView");
+            std::memcpy(&header, data, sizeof(header));
+            if (header.big_endian != BigNumHeader::host_big_endian())
+                throw std::invalid_argument("ia in BigNumView");
+            num_t::check_header(header);
+            if ((size - sizeof(header)) / sizeof(elt_t) < header.count)
+                throw std::length_error("le in BigNumView");
+
+            limbs_ = reinterpret_cast<const elt_t*>(
+                static_cast<const char*>(data) + sizeof(header));
+            count_ = header.count;
+            base_ = header.base;
+            is_positive_ = header.positive;
+            if (count_ && !limbs_[count_ - 1])
+                throw std::invalid_argument("ia in BigNumView");
+        }
+
+        /// Get the numerical base in which the number is represented.
+        std::size_t get_base_num() const
+        {
+            return base_;
+        }
+
+        /// Get the number of digits in the base representation of the number.
+        index_t get_num_digits() const
+        {
+            if constexpr (num_t::is_packed)
+                return num_t::count_digits(limbs_, count_);
+            else
+                return count_;
+        }
+
+        /**
+        ** Get the \a i th digit in the base representation of the number, 0
+        ** being the least significant digit.
+        **
+        ** \throw std::out_of_range exception if the digit asked is over the
+        ** number of digits in the BigNum.
+        **/
+        digit_t get_digit(index_t i) const
+        {
+            if (i >= get_num_digits())
+                throw std::out_of_range("oor in get_digit");
+            if constexpr (num_t::is_packed)
+                return num_t::extract_digit(limbs_, count_, i);
+            else
+                return limbs_[i];
+        }
+
+        /// Return the sign of the BigNum.
+        bool is_positive() const
+        {
+            return is_positive_;
+        }
+
+        /// Copy the number viewed into a BigNum.
+        num_t load() const
+        {
+            num_t res(base_);
+            res.set_positive(is_positive_);
+            res.number_.assign(limbs_, limbs_ + count_);
+            return res;
+        }
+
+    private:
+        /// Element of the digit container: a digit, or a limb if packed.
+        using elt_t = typename num_t::elt_t;
+
+        const elt_t* limbs_;
+        std::size_t count_;
+        std::size_t base_;
+        bool is_positive_;
+    };
+}
@@ -1,10 +1,18 @@
 #pragma once
 
 #include <cstdint>  // uint8_t
+#include <cstring>  // memcmp
 #include <fstream>  // ifstream
+#include <future>   // async
 #include <iostream> // ostream
+#include <limits>   // numeric_limits
+#include <algorithm> // min
 #include <memory>   // shared_ptr
+#include <sstream>  // ostringstream
+#include <string_view>
+#include <type_traits> // conditional_t
 #include "base.hh"
+#include "output-buffer.hh"
 #include <vector>
 #include <ctype.h>
 #include <stdexcept>
@@ -12,6 +20,56 @@
 
 namespace bistro
 {
+    template <typename T, std::size_t Radix>
+    class BigNumView;
+
+    /**
+    ** Header of a BigNum in binary form, see BigNum::save.
+    **
+    ** It is followed by \a count limbs of \a limb_width bytes, least
+    ** significant first, in the byte order given by \a big_endian, as are
+    ** \a base and \a count. Its size keeps the limbs aligned.
+    **/
+    struct BigNumHeader
+    {
+        /// Magic bytes, "BNUM".
+        char magic[4];
+        /// Version of the format, 2.
+        uint8_t version;
+        /// Size of a limb, in bytes.
+        uint8_t limb_width;
+        /// Whether the limbs hold packed digits, or one digit each.
+        uint8_t packed;
+        /// Sign of the number.
+        uint8_t positive;
+        /// Whether the integers are big-endian, or little-endian.
+        uint8_t big_endian;
+        /// Zeros, up to the alignment of the integers.
+        uint8_t reserved[7];
+        /// Base of the number.
+        uint64_t base;
+        /// Number of limbs.
+        uint64_t count;
+
+        /// Whether the integers of the host are big-endian.
+        static bool host_big_endian()
+        {
+            const uint16_t one = 1;
+            uint8_t first;
+            std::memcpy(&first, &one, 1);
+            return !first;
+        }
+
+        /// Reverse the bytes of \a x.
+        template <typename U>
+        static U byte_swap(U x)
+        {
+            U res = 0;
+            for (std::size_t i = 0; i < sizeof(U); i++, x >>= 8)
+                res = (res << 8) | (x & 0xff);
+            return res;
+        }
+    };
 
     /**
     ** BigNum class.
@@ -21,10 +79,22 @@ namespace bistro
     **
     ** The parameter \a T can be any unsigned integer type (\c uint8_t,
     ** \c uint16_t, ...).
+    **
+    ** A nonzero \a Radix fixes the base at compile time: base checks are
+    ** resolved statically and the carry divisions become divisions by a
+    ** constant. With \a Radix = 0, the base is chosen at runtime.
+    **
+    ** When \a Radix is a power of two, the digits are packed as bit-fields of
+    ** 64-bit limbs, i.e. the number is stored in binary: digits are read and
+    ** written by bit-slicing and arithmetic runs on whole machine words.
     */
-    template <typename T = uint8_t>
+    template <typename T = uint8_t, std::size_t Radix = 0>
     class BigNum
     {
+        static_assert(Radix == 0
+                      || Radix - 1 <= std::numeric_limits<T>::max(),
+                      "the digits of Radix must fit in T");
+
     public:
         /// Type of a single digit.
         using digit_t = T;
@@ -38,8 +108,17 @@ namespace bistro
         /// Shared pointer to const self.
         using const_self_ptr_t = std::shared_ptr<const BigNum>;
 
-        /// Type of the digit container.
-        using digits_t = std::vector<T>;
+        /// Type of a limb, holding several digits in packed mode.
+        using limb_t = uint64_t;
+
+        /// Compile-time base, or 0 if the base is only known at runtime.
+        static constexpr std::size_t static_radix = Radix;
+
+        /// Whether the digits are packed as bit-fields of 64-bit limbs.
+        static constexpr bool is_packed = Radix > 1 && !(Radix & (Radix - 1));
+
+        /// Type of the digit container (of the limb container if packed).
+        using digits_t = std::vector<std::conditional_t<is_packed, limb_t, T>>;
 
         /// Type used as index.
         using index_t = size_t;
@@ -49,10 +128,14 @@ namespace bistro
         **
         ** \a base is the numeric value of the base in which the number will be
         ** represented.
+        **
+        ** \throw std::invalid_argument if \a base differs from a nonzero
+        ** \a Radix.
         **/
         BigNum(std::size_t base) : base_(base),
         is_positive_(1)
         {
+            check_radix(base);
         }
 
         /**
@@ -65,23 +148,47 @@ namespace bistro
         **/
         template <typename Base>
         BigNum(std::istream& in, const Base& b)
+            : BigNum(std::string_view(read_digits(in, b)), b)
         {
-            base_ = b.get_base_num();
-            is_positive_ = 1;
-            std::string line;
-            getline(in, line);
-            if (line.length() == 0)
+        }
+
+        /**
+        ** Construct the number from its textual representation \a digits,
+        ** most significant digit first, with base \a b.
+        **
+        ** The digits are decoded in place, without any intermediate copy.
+        ** If \a b is not of the static radix, the number is converted by
+        ** divide and conquer (see convert), the halves being converted on up
+        ** to \a jobs threads.
+        **
+        ** \throw std::length_error if \a digits is empty.
+        ** \throw std::out_of_range if a character is not a digit of \a b.
+        **/
+        template <typename Base>
+        BigNum(std::string_view digits, const Base& b, std::size_t jobs = 1)
+            : base_(Radix ? Radix : b.get_base_num())
+            , is_positive_(1)
+        {
+            if (digits.empty())
                 throw std::length_error("le in construsctor");
-            do
+            if (b.get_base_num() != radix())
             {
-                for(ssize_t i = line.length() - 1 ; i >= 0 && b.is_digit(line[0]); --i)
+                auto digit = [&digits, &b](index_t i)
                 {
-                    number_.push_back(b.get_char_value(line[i]));
-                }
+                    return b.get_char_value(digits[digits.size() - 1 - i]);
+                };
+                *this = from_digits(digit, digits.size(), b.get_base_num(),
+                                    radix(), jobs);
+                return;
             }
-            while (getline(in, line));
+            if constexpr (!is_packed)
+                number_.reserve(digits.size());
+            index_t n = 0;
+            for (auto it = digits.rbegin(); it != digits.rend(); ++it)
+                push_digit(n++, b.get_char_value(*it));
+            // "007" is 7.
+            strip_leading_zeros();
         }
-        
 
         /// Disable copy constructor.
         BigNum(const BigNum&) = delete;
@@ -98,17 +205,26 @@ namespace bistro
         /// Clone the bignum into a new instance.
         self_t clone() const
         {
-            BigNum clone;
+            BigNum clone(radix());
             clone.is_positive_ = is_positive_;
             clone.number_ = number_;
             clone.base_ = base_;
             return clone;
         }
 
+        /// Get the numerical base in which the number is represented.
+        std::size_t get_base_num() const
+        {
+            return radix();
+        }
+
         /// Get the number of digits in the base representation of the number.
         index_t get_num_digits() const
         {
-            return number_.size();
+            if constexpr (is_packed)
+                return count_digits(number_.data(), number_.size());
+            else
+                return number_.size();
         }
 
         /**
@@ -120,7 +236,14 @@ namespace bistro
         **/
         digit_t get_digit(index_t i) const
         {
-            return number_.at(i);
+            if constexpr (is_packed)
+            {
+                if (i >= get_num_digits())
+                    throw std::out_of_range("oor in get_digit");
+                return extract_digit(i);
+            }
+            else
+                return number_.at(i);
         }
 
         /**
@@ -137,16 +260,47 @@ namespace bistro
         **/
         void set_digit(index_t i, digit_t d)
         {
-            if (d > base_)
+            if (d >= radix())
                 throw std::invalid_argument("ia in set_digit");
+            if constexpr (is_packed)
+            {
+                std::size_t bit = i * digit_bits;
+                std::size_t last = (bit + digit_bits - 1) / limb_bits;
+                if (number_.size() <= last)
+                    number_.resize(last + 1);
+                clear_digit(i);
+                push_digit(i, d);
+                strip_leading_zeros();
+                return;
+            }
             if (i < number_.size())
             {
                 number_.at(i) = d;
                 return;
             }
-            for (size_t y = number_.size(); y < i; ++y)
-                number_.push_back(0);
-            number_.push_back(d);
+            number_.resize(i + 1, 0);
+            number_[i] = d;
+        }
+
+        /**
+        ** Reserve room for \a n digits, e.g. before setting them from the
+        ** most significant with set_digit.
+        **/
+        void reserve(index_t n)
+        {
+            if constexpr (is_packed)
+                number_.reserve((n * digit_bits + limb_bits - 1) / limb_bits);
+            else
+                number_.reserve(n);
+        }
+
+        /// Memory used by a digit, in bytes.
+        static constexpr double digit_bytes()
+        {
+            if constexpr (is_packed)
+                return digit_bits / 8.;
+            else
+                return sizeof(T);
         }
 
         /**
@@ -171,50 +325,155 @@ namespace bistro
         **
         ** The output is not followed by a newline.
         **
-        ** \throw std::invalid_argument if the size of \a b is not the base of \a this.
+        ** If the size of \a b is not the base of \a this, the number is
+        ** converted to the base of \a b first, see convert.
         **/
         template <typename Base>
         std::ostream& print(std::ostream& out, const Base& b) const
         {
-            if (!is_positive())
+            if (!is_positive() && *this)
                 out << '-';
-            for (ssize_t i = number_.size() - 1; i >= 0; i--)
-            {
-                out << b.get_digit_representation(number_.at(i));
-            }
-            return out;
+            return print_digits(out, b);
         }
 
         /// Output the number in polish notation (i.e. -2 becomes "- 0 2").
         template <typename Base>
         std::ostream& print_pol(std::ostream& out, const Base& b) const
         {
-            if (!is_positive())
-                out << "- 0 ";
-            
-            for (size_t i = 0; i < number_.size(); i++)
-            {
-                out << b.get_char_value(number_.at(i));
-            }
-            return out;
-            
+            bool negative = !is_positive() && *this;
+            if (negative)
+                out << "- " << b.get_digit_representation(0) << ' ';
+            return print_digits(out, b);
         }
 
         /// Output the number in reverse polish notation (i.e. -2 becomes "0 2 -").
         template <typename Base>
         std::ostream& print_rpol(std::ostream& out, const Base& b) const
         {
-            if (!is_positive())
-                out << '0';
-            for (size_t i = 0; i < number_.size(); i++)
+            bool negative = !is_positive() && *this;
+            if (negative)
+                out << b.get_digit_representation(0) << ' ';
+            print_digits(out, b);
+            if (negative)
+                out << " -";
+            return out;
+        }
+
+        /// Output the digits, most significant first, without the sign.
+        template <typename Base>
+        void print_digits(OutputBuffer& buf, const Base& b) const
+        {
+            if constexpr (std::is_same_v<typename Base::char_t, char>)
             {
-                out << b.get_char_value(number_.at(i));
+                // 0 may have no digits.
+                if (!get_num_digits())
+                    return buf.put(b.get_digit_representation(0));
+                if (b.get_base_num() != radix())
+                    return convert(b).print_digits(buf, b);
+                render_digits(buf, b);
+            }
+            else
+            {
+                std::ostringstream out;
+                print_digits(out, b);
+                const std::string str = out.str();
+                buf.write(str.data(), str.size());
             }
-            if (!is_positive())
-                out << '-';
-            return out;
         }
-        
+
+
+        /**
+        ** Convert the number to the base of \a b.
+        **
+        ** The digits are split recursively in two, and the converted halves
+        ** are combined as hi * R^n + lo in the target base, R being the base
+        ** of \a this and n the number of digits of lo. The powers of R are
+        ** cached per thread, so the conversion costs O(M(n) log n), M(n)
+        ** being the cost of a product.
+        **/
+        template <typename Base>
+        BigNum<typename Base::value_t> convert(const Base& b) const
+        {
+            using target_t = BigNum<typename Base::value_t>;
+            auto digit = [this](index_t i)
+            {
+                return digit_at(i);
+            };
+            target_t res = target_t::from_digits(digit, get_num_digits(),
+                                                 radix(), b.get_base_num(), 1);
+            res.set_positive(is_positive());
+            return res;
+        }
+
+        /**
+        ** Write the number to \a out in binary: a BigNumHeader, then the raw
+        ** limbs (the digits if not packed).
+        **
+        ** The output is read back by load, or in place by a BigNumView.
+        **/
+        void save(std::ostream& out) const
+        {
+            BigNumHeader header = {{'B', 'N', 'U', 'M'}, 2, sizeof(elt_t),
+                                   is_packed, is_positive(),
+                                   BigNumHeader::host_big_endian(), {},
+                                   radix(), number_.size()};
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(number_.data()),
+                      number_.size() * sizeof(elt_t));
+        }
+
+        /**
+        ** Read a number written by save from \a in, on a host of any byte
+        ** order.
+        **
+        ** \throw std::invalid_argument if the header doesn't describe a
+        ** BigNum of this type, or if a digit is not below the base or is a
+        ** leading zero.
+        ** \throw std::length_error if the input is truncated.
+        **/
+        static self_t load(std::istream& in)
+        {
+            BigNumHeader header;
+            if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)))
+                throw std::length_error("le in load");
+            bool swap = header.big_endian != BigNumHeader::host_big_endian();
+            if (swap)
+            {
+                header.base = BigNumHeader::byte_swap(header.base);
+                header.count = BigNumHeader::byte_swap(header.count);
+            }
+            check_header(header);
+
+            // A corrupt count must not allocate more than the input holds.
+            std::streampos begin = in.tellg();
+            if (begin != std::streampos(-1))
+            {
+                in.seekg(0, std::ios::end);
+                std::streamoff left = in.tellg() - begin;
+                in.seekg(begin);
+                if (left < 0 || uint64_t(left) / sizeof(elt_t) < header.count)
+                    throw std::length_error("le in load");
+            }
+
+            self_t res(header.base);
+            res.is_positive_ = header.positive;
+            // Without the size of the input, e.g. from a pipe, the limbs are
+            // read by chunks.
+            constexpr std::size_t chunk = (1 << 20) / sizeof(elt_t);
+            for (std::size_t n = 0; n < header.count; n += chunk)
+            {
+                std::size_t k = std::min<uint64_t>(chunk, header.count - n);
+                res.number_.resize(n + k);
+                if (!in.read(reinterpret_cast<char*>(res.number_.data() + n),
+                             k * sizeof(elt_t)))
+                    throw std::length_error("le in load");
+            }
+            if (swap)
+                for (auto& limb : res.number_)
+                    limb = BigNumHeader::byte_swap(limb);
+            check_limbs(res.number_.data(), header);
+            return res;
+        }
 
         ///@{
         /**
@@ -224,145 +483,926 @@ namespace bistro
 
         self_t operator+(const self_t& other) const
         {
-            self_t res (base_);
+            return add_signed(other, other.is_positive());
+        }
+
+        self_t operator-(const self_t& other) const
+        {
+            return add_signed(other, !other.is_positive());
+        }
 
-            if (!this->is_positive() && !other.is_positive())
+        /// Karatsuba above \a karatsuba_threshold digits (limbs if packed).
+        self_t operator*(const self_t& other) const
+        {
+            check_base(other);
+            size_t size_self = number_.size();
+            size_t size_other = other.number_.size();
+            self_t result (radix());
+
+            if (size_self == 0 || size_other == 0)
+                return result;
+
+            result.set_positive(is_positive() == other.is_positive());
+            result.number_.resize(size_self + size_other);
+            mul_karatsuba(number_.data(), size_self,
+                          other.number_.data(), size_other,
+                          result.number_.data());
+            result.strip_leading_zeros();
+            return result;
+        }
+
+
+        /// \throw std::overflow_error for a division by 0.
+        self_t operator/(const self_t& other) const
+        {
+            self_t quotient(radix());
+            self_t remainder(radix());
+            divmod(other, quotient, remainder);
+            return quotient;
+        }
+
+        /**
+        ** Modulus, with the C/C++ convention.
+        **
+        ** \throw std::overflow_error for a modulo 0.
+        **/
+        self_t operator%(const self_t& other) const
+        {
+            self_t quotient(radix());
+            self_t remainder(radix());
+            divmod(other, quotient, remainder);
+            return remainder;
+        }
+
+        /**
+        ** Raise the number to the power \a exponent, by squaring: each digit
+        ** of \a exponent, from the most significant, raises the result to the
+        ** power of the base, then multiplies it by the number to the power of
+        ** the digit.
+        **
+        ** \throw std::domain_error for a negative exponent.
+        **/
+        self_t pow(const self_t& exponent) const
+        {
+            check_base(exponent);
+            if (exponent && !exponent.is_positive())
+                throw std::domain_error("negative exponent");
+            self_t res = from_limb(1, radix());
+            for (index_t i = exponent.get_num_digits(); i-- > 0;)
+            {
+                res = pow_limb(res, radix());
+                if (limb_t d = exponent.digit_at(i))
+                    res = res * pow_limb(*this, d);
+            }
+            return res;
+        }
+
+        self_t sqrt() const;
+
+        self_t log(const self_t& base) const;
+
+        /// Add \a other in place, reusing the digits of the number.
+        self_t& operator+=(const self_t& other)
+        {
+            return add_in(other, other.is_positive());
+        }
+
+        /// Subtract \a other in place, reusing the digits of the number.
+        self_t& operator-=(const self_t& other)
+        {
+            return add_in(other, !other.is_positive());
+        }
+
+        self_t& operator*=(const self_t& other)
+        {
+            return *this = *this * other;
+        }
+
+        self_t& operator/=(const self_t& other)
+        {
+            return *this = *this / other;
+        }
+
+        self_t& operator%=(const self_t& other)
+        {
+            return *this = *this % other;
+        }
+
+        self_t& pow_inplace(const self_t& exponent)
+        {
+            return *this = pow(exponent);
+        }
+
+        self_t& sqrt_inplace();
+
+        self_t& log_inplace(const self_t& base);
+
+        bool operator>(const self_t& other) const
+        {
+            check_base(other);
+            bool zero = !*this && !other;
+            if (zero || is_positive() != other.is_positive())
+                return !zero && is_positive();
+            int cmp = cmp_abs(number_, other.number_);
+            return is_positive() ? cmp > 0 : cmp < 0;
+        }
+
+        bool operator==(const self_t& other) const
+        {
+            check_base(other);
+            int cmp = cmp_abs(number_, other.number_);
+            return !cmp && (is_positive() == other.is_positive() || !*this);
+        }
+        ///@}
+
+        /// Returns true if the number is not 0, false otherwise
+        explicit operator bool() const
+        {
+            for (auto e : number_)
+                if (e)
+                    return true;
+            return false;
+        }
+
+    private:
+        template <typename, std::size_t>
+        friend class BigNum;
+
+        template <typename, std::size_t>
+        friend class BigNumView;
+
+        /// Element of the digit container: a digit, or a limb if packed.
+        using elt_t = typename digits_t::value_type;
+
+        /**
+        ** Add \a other, with the sign \a other_positive instead of its own,
+        ** to the number.
+        **/
+        self_t add_signed(const self_t& other, bool other_positive) const
+        {
+            check_base(other);
+            if (is_positive() != other_positive)
+            {
+                // Subtract the lesser magnitude from the greater.
+                bool less = cmp_abs(number_, other.number_) < 0;
+                const self_t& big = less ? other : *this;
+                const self_t& small = less ? *this : other;
+                self_t res = big.clone();
+                res.set_positive(less ? other_positive : is_positive());
+                sub_in(res.number_.data(), res.number_.size(),
+                       small.number_.data(), small.number_.size());
+                res.strip_leading_zeros();
+                return res;
+            }
+
+            self_t res(radix());
+            res.set_positive(is_positive());
+
+            const digits_t& longest = number_.size() >= other.number_.size()
+                ? number_ : other.number_;
+            const digits_t& shortest = number_.size() >= other.number_.size()
+                ? other.number_ : number_;
+
+            res.number_.reserve(longest.size() + 1);
+            std::size_t retenu = 0;
+            if constexpr (is_packed)
             {
-                res.set_positive(0);
+                // Packed digits are a binary number: add whole limbs.
+                for (size_t i = 0; i < longest.size(); i++)
+                {
+                    limb_t add = longest[i] + retenu;
+                    retenu = add < retenu;
+                    if (i < shortest.size())
+                    {
+                        add += shortest[i];
+                        retenu |= add < shortest[i];
+                    }
+                    res.number_.push_back(add);
+                }
             }
-            if (base_ != other.base_)
+            else
             {
-                throw std::invalid_argument("not same base");
+                const std::size_t base = radix();
+                for (size_t i = 0; i < longest.size(); i++)
+                {
+                    std::size_t add = longest[i] + retenu;
+                    if (i < shortest.size())
+                        add += shortest[i];
+                    retenu = add >= base;
+                    res.number_.push_back(retenu ? add - base : add);
+                }
             }
-            
-            int retenu = 0;
-            if (!this->is_positive() && !other.is_positive())
-                res.set_positive(false);
-            size_t i = 0;
-            for (; i < other.number_.size() && i < number_.size(); i++)
+            if (retenu)
+                res.number_.push_back(retenu);
+
+            return res;
+        }
+
+        /**
+        ** Add \a other, with the sign \a other_positive instead of its own,
+        ** to the number in place. The digits are only reallocated if the sum
+        ** does not fit, or if \a other is subtracted from a lesser magnitude.
+        **/
+        self_t& add_in(const self_t& other, bool other_positive)
+        {
+            check_base(other);
+            if (is_positive() != other_positive)
+            {
+                if (cmp_abs(number_, other.number_) < 0)
+                    return *this = add_signed(other, other_positive);
+                sub_in(number_.data(), number_.size(), other.number_.data(),
+                       other.number_.size());
+                strip_leading_zeros();
+                return *this;
+            }
+
+            // other may be the number itself: it is read before written.
+            const std::size_t n = other.number_.size();
+            if (number_.size() < n)
+                number_.resize(n);
+            std::size_t retenu = 0;
+            for (size_t i = 0; i < number_.size() && (i < n || retenu); i++)
             {
-                size_t add = number_.at(i) + other.number_.at(i) + retenu;
-                if(add > base_)
+                if constexpr (is_packed)
                 {
-                    retenu = 1;
-                    res.set_digit(i, add - base_);
+                    limb_t add = number_[i] + retenu;
+                    retenu = add < retenu;
+                    if (i < n)
+                    {
+                        limb_t digit = other.number_[i];
+                        add += digit;
+                        retenu |= add < digit;
+                    }
+                    number_[i] = add;
                 }
                 else
                 {
-                    retenu = 0;
-                    res.set_digit(i, add) ;
+                    std::size_t add = number_[i] + retenu;
+                    if (i < n)
+                        add += other.number_[i];
+                    retenu = add >= radix();
+                    number_[i] = retenu ? add - radix() : add;
+                }
+            }
+            if (retenu)
+                number_.push_back(retenu);
+            return *this;
+        }
+
+        /**
+        ** Divide the number by \a other, truncating the quotient toward 0 as
+        ** in C/C++: the remainder has the sign of the number.
+        **
+        ** This is a schoolbook long division on the digits (limbs if packed):
+        ** each digit of the quotient is searched for by dichotomy, between the
+        ** bounds given by the leading digits of the operands.
+        **
+        ** \throw std::overflow_error for a division by 0.
+        **/
+        void divmod(const self_t& other, self_t& quotient,
+                    self_t& remainder) const
+        {
+            check_base(other);
+            if (!other)
+                throw std::overflow_error("division by zero");
+            const digits_t& d = other.number_;
+            std::size_t nd = d.size();
+            while (!d[nd - 1])
+                nd--;
+            const dlimb_t base = is_packed ? dlimb_t(1) << limb_bits
+                                           : dlimb_t(radix());
+
+            digits_t& q = quotient.number_;
+            digits_t& r = remainder.number_;
+            q.assign(number_.size(), 0);
+            r.clear();
+            r.reserve(nd + 1);
+            digits_t t;
+            for (std::size_t i = number_.size(); i-- > 0;)
+            {
+                // r < d, so r * base + number_[i] < d * base.
+                r.insert(r.begin(), number_[i]);
+                strip_leading_zeros(r);
+                if (cmp_abs(r, d) < 0)
+                    continue;
+
+                std::size_t nr = r.size();
+                dlimb_t top = r[nr - 1];
+                if (nr > nd)
+                    top = top * base + r[nr - 2];
+                dlimb_t lo = top / (dlimb_t(d[nd - 1]) + 1);
+                dlimb_t hi = std::min(top / d[nd - 1], base - 1);
+                lo = std::max(lo, dlimb_t(1));
+                while (lo < hi)
+                {
+                    dlimb_t mid = lo + (hi - lo + 1) / 2;
+                    mul_limb(d.data(), nd, mid, t);
+                    if (cmp_abs(t, r) <= 0)
+                        lo = mid;
+                    else
+                        hi = mid - 1;
                 }
+                mul_limb(d.data(), nd, lo, t);
+                sub_in(r.data(), r.size(), t.data(), t.size());
+                strip_leading_zeros(r);
+                q[i] = lo;
             }
-            
-            if (i >= other.number_.size() && i < number_.size())
-                for (; i < number_.size(); i++)
+            quotient.strip_leading_zeros();
+            quotient.set_positive(is_positive() == other.is_positive());
+            remainder.set_positive(is_positive());
+        }
+
+        /// Multiply the \a n elements at \a a by \a w, into \a out.
+        void mul_limb(const elt_t* a, std::size_t n, limb_t w,
+                      digits_t& out) const
+        {
+            // Digits of at most 32 bits keep the products within a limb.
+            using wide_t = std::conditional_t<!is_packed && sizeof(T) <= 4,
+                                              limb_t, dlimb_t>;
+            out.resize(n + 1);
+            wide_t carry = 0;
+            for (std::size_t i = 0; i < n; i++)
+            {
+                wide_t p = wide_t(a[i]) * w + carry;
+                if constexpr (is_packed)
                 {
-                    res.set_digit(i, number_.at(i + retenu));
-                    retenu = 0;
+                    out[i] = p;
+                    carry = p >> limb_bits;
                 }
-            else if (i < other.number_.size() && i >= number_.size())
-                for (; i < other.number_.size(); i++)
+                else
                 {
-                    res.set_digit(i, other.number_.at(i) + retenu);
-                    retenu = 0;
+                    out[i] = p % radix();
+                    carry = p / radix();
                 }
-            else if (i >= other.number_.size() && i >= number_.size() && retenu)
-                res.set_digit(i,  retenu);
+            }
+            out[n] = carry;
+        }
 
+        /// Raise \a x to the power \a k, by squaring.
+        static self_t pow_limb(const self_t& x, limb_t k)
+        {
+            self_t res = from_limb(1, x.radix());
+            self_t square = x.clone();
+            for (; k; k >>= 1)
+            {
+                if (k & 1)
+                    res = res * square;
+                if (k > 1)
+                    square = square * square;
+            }
             return res;
         }
 
-        self_t operator-(const self_t& other) const;
-        
-        self_t operator*(const self_t& other) const
+        /// Compare the magnitudes \a a and \a b, as -1, 0 or 1.
+        static int cmp_abs(const digits_t& a, const digits_t& b)
         {
-            size_t size_self = number_.size();
-            size_t size_other = other.number_.size();
-            self_t result (base_);
-            result.number_.resize(size_self + size_other);
+            std::size_t na = a.size();
+            std::size_t nb = b.size();
+            while (na && !a[na - 1])
+                na--;
+            while (nb && !b[nb - 1])
+                nb--;
+            if (na != nb)
+                return na < nb ? -1 : 1;
+            for (std::size_t i = na; i-- > 0;)
+                if (a[i] != b[i])
+                    return a[i] < b[i] ? -1 : 1;
+            return 0;
+        }
 
+        /// Operand size under which operator* runs the schoolbook algorithm.
+        static constexpr size_t karatsuba_threshold = 32;
 
-            if (size_self == 0 || size_other == 0)
-                return result;
+        /// Number of bits in \a x, i.e. log2(\a x) for a power of two.
+        static constexpr unsigned log2(std::size_t x)
+        {
+            unsigned res = 0;
+            while (x >>= 1)
+                res++;
+            return res;
+        }
+
+        /// Double limb, holding the product of two limbs.
+        __extension__ typedef unsigned __int128 dlimb_t;
+
+        /// Width of a limb, in bits.
+        static constexpr unsigned limb_bits = 64;
+
+        /// Width of a packed digit, in bits.
+        static constexpr unsigned digit_bits = log2(Radix);
 
+        /// Mask of the bits of a packed digit.
+        static constexpr limb_t digit_mask = (limb_t(1) << digit_bits) - 1;
 
-            size_t index_self = 0;
-            size_t index_other = 0;
-            
-            for (size_t i = 0; i < size_self; i++)
+        /**
+        ** Write \a d as the \a i th digit, the digits under \a i being already
+        ** written: in packed mode, \a d is or-ed in the limbs, which may
+        ** straddle two limbs when \a digit_bits does not divide 64.
+        **/
+        void push_digit(index_t i, digit_t d)
+        {
+            if constexpr (is_packed)
             {
-                size_t carry = 0;
-                size_t n1 = number_.at(i);
-                
-                index_other = 0;
-                
-                for (size_t j = 0; j < size_other; j++)
+                std::size_t bit = i * digit_bits;
+                std::size_t limb = bit / limb_bits;
+                unsigned off = bit % limb_bits;
+                if (number_.size() <= limb)
+                    number_.resize(limb + 1);
+                number_[limb] |= limb_t(d) << off;
+                if (off + digit_bits > limb_bits)
                 {
-                    size_t n2 = other.number_.at(j);
-                
-                    size_t sum = n1*n2 + result.number_.at(index_self + index_other) + carry;
-                    
-                    carry = sum/base_;
-                    result.set_digit(index_self + index_other, sum % base_);
-                    
-                    index_other++;
+                    if (number_.size() <= limb + 1)
+                        number_.resize(limb + 2);
+                    number_[limb + 1] |= limb_t(d) >> (limb_bits - off);
                 }
-                
-                if (carry > 0)
-                    result.number_.at(index_self + index_other) += carry;
+            }
+            else
+                number_.push_back(d);
+        }
+
+        /// Extract the \a i th packed digit from the limbs.
+        digit_t extract_digit(index_t i) const
+        {
+            return extract_digit(number_.data(), number_.size(), i);
+        }
 
-                index_self++;
+        /// Read the \a i th digit packed in the \a n limbs at \a limbs.
+        static digit_t extract_digit(const limb_t* limbs, std::size_t n,
+                                     index_t i)
+        {
+            std::size_t bit = i * digit_bits;
+            std::size_t limb = bit / limb_bits;
+            unsigned off = bit % limb_bits;
+            limb_t d = limbs[limb] >> off;
+            if (off + digit_bits > limb_bits && limb + 1 < n)
+                d |= limbs[limb + 1] << (limb_bits - off);
+            return d & digit_mask;
+        }
+
+        /// Number of digits packed in the \a n limbs at \a limbs.
+        static index_t count_digits(const limb_t* limbs, std::size_t n)
+        {
+            if (!n)
+                return 0;
+            std::size_t bits = limb_bits * n - __builtin_clzll(limbs[n - 1]);
+            return (bits + digit_bits - 1) / digit_bits;
+        }
+
+        /// Reset the \a i th packed digit to 0.
+        void clear_digit(index_t i)
+        {
+            std::size_t bit = i * digit_bits;
+            std::size_t limb = bit / limb_bits;
+            unsigned off = bit % limb_bits;
+            number_[limb] &= ~(digit_mask << off);
+            if (off + digit_bits > limb_bits)
+                number_[limb + 1] &= ~(digit_mask >> (limb_bits - off));
+        }
+
+        /// Output the digits, most significant first, without the sign.
+        template <typename Base>
+        std::ostream& print_digits(std::ostream& out, const Base& b) const
+        {
+            // 0 may have no digits.
+            if (!get_num_digits())
+                return out << b.get_digit_representation(0);
+            if (b.get_base_num() != radix())
+                return convert(b).print_digits(out, b);
+            if constexpr (std::is_same_v<typename Base::char_t, char>)
+            {
+                OutputBuffer buf(out);
+                render_digits(buf, b);
             }
-            
-            
-            
-            return result;
+            else
+            {
+                for (index_t i = get_num_digits(); i-- > 0;)
+                    out << b.get_digit_representation(get_digit(i));
+            }
+            return out;
         }
-        
 
-        /// \throw std::overflow_error for a division by 0.
-        self_t operator/(const self_t& other) const;
+        /**
+        ** Render the digits in \a buf, through a table of the representations
+        ** of \a b. In packed mode, when the digits tile the bytes of the limbs
+        ** (bases 2, 4 and 16), each byte is rendered with a single lookup.
+        **
+        ** \throw std::out_of_range if a digit is not in \a b.
+        **/
+        template <typename Base>
+        void render_digits(OutputBuffer& buf, const Base& b) const
+        {
+            // A char base has at most 256 digits.
+            if (radix() > 256)
+                throw std::out_of_range("oor in print");
+            char repr[256];
+            for (std::size_t d = 0; d < radix(); d++)
+                repr[d] = b.get_digit_representation(d);
+
+            if constexpr (is_packed && digit_bits < 8 && 8 % digit_bits == 0)
+            {
+                constexpr unsigned per_byte = 8 / digit_bits;
+                char table[256 * per_byte];
+                for (unsigned v = 0; v < 256; v++)
+                    for (unsigned k = 0; k < per_byte; k++)
+                        table[v * per_byte + k] =
+                            repr[(v >> (digit_bits * (per_byte - 1 - k)))
+                                 & digit_mask];
+
+                // Leading digits of a partial byte, then whole bytes.
+                index_t i = get_num_digits();
+                for (; i % per_byte; i--)
+                    buf.put(repr[extract_digit(i - 1)]);
+                for (std::size_t byte = i / per_byte; byte-- > 0;)
+                {
+                    unsigned v = (number_[byte / 8] >> (8 * (byte % 8))) & 0xff;
+                    buf.write(table + v * per_byte, per_byte);
+                }
+            }
+            else if constexpr (is_packed)
+            {
+                for (index_t i = get_num_digits(); i-- > 0;)
+                    buf.put(repr[extract_digit(i)]);
+            }
+            else
+            {
+                for (index_t i = number_.size(); i-- > 0;)
+                    buf.put(repr[number_[i]]);
+            }
+        }
+
+        /// Get the \a i th digit, which must exist.
+        digit_t digit_at(index_t i) const
+        {
+            if constexpr (is_packed)
+                return extract_digit(i);
+            else
+                return number_[i];
+        }
 
         /**
-        ** Modulus, with the C/C++ convention.
+        ** Build the number of value \a v in base \a base.
         **
-        ** \throw std::overflow_error for a modulo 0.
+        ** \throw std::invalid_argument if \a v is not 0 in base 1.
         **/
-        self_t operator%(const self_t& other) const;
+        static self_t from_limb(limb_t v, std::size_t base)
+        {
+            // Only 0 is written in base 1, without any digit.
+            if (v && base < 2)
+                throw std::invalid_argument("ia in from_limb");
+            self_t res(base);
+            for (index_t n = 0; v; n++)
+            {
+                res.push_digit(n, v % base);
+                v /= base;
+            }
+            return res;
+        }
 
-        self_t pow(const self_t& exponent) const;
+        /// Read the digits of \a b at the start of \a in.
+        template <typename Base>
+        static std::string read_digits(std::istream& in, const Base& b)
+        {
+            std::string digits;
+            for (int c = in.peek(); c != EOF && b.is_digit(c); c = in.peek())
+                digits.push_back(in.get());
+            return digits;
+        }
 
-        self_t sqrt() const;
+        /**
+        ** Build the number of base \a to whose value is written with the \a len
+        ** digits of base \a from given by \a digit, from the least significant.
+        **
+        ** The digits are split recursively in two, and the converted halves
+        ** are combined as hi * from^n + lo, n being the number of digits of
+        ** lo. The powers of \a from are cached per thread, for the last pair
+        ** of bases converted.
+        **
+        ** \throw std::invalid_argument if \a from is 0.
+        **/
+        template <typename Digit>
+        static self_t from_digits(const Digit& digit, index_t len,
+                                  std::size_t from, std::size_t to,
+                                  std::size_t jobs)
+        {
+            // The only digit of base 1 is 0, whatever the number of digits.
+            if (from < 2)
+            {
+                if (!from)
+                    throw std::invalid_argument("ia in from_digits");
+                return from_limb(0, to);
+            }
 
-        self_t log(const self_t& base) const;
+            // A leaf of up to leaf_size digits is converted through a limb.
+            std::size_t leaf_size = 1;
+            limb_t leaf_power = from;
+            while (leaf_power <= std::numeric_limits<limb_t>::max() / from)
+            {
+                leaf_power *= from;
+                leaf_size++;
+            }
 
-        self_t& operator+=(const self_t& other);
+            // powers[k] is from^(leaf_size 2^k), in base to. The ones needed
+            // are computed beforehand, so that the halves only read them.
+            thread_local std::size_t cached_from = 0;
+            thread_local std::size_t cached_to = 0;
+            thread_local std::vector<self_t> powers;
+            if (cached_from != from || cached_to != to)
+            {
+                powers.clear();
+                cached_from = from;
+                cached_to = to;
+            }
+            if (powers.empty())
+                powers.push_back(from_limb(leaf_power, to));
+            while ((leaf_size << powers.size()) < len)
+                powers.push_back(powers.back() * powers.back());
 
-        self_t& operator-=(const self_t& other);
+            return convert_digits(digit, 0, len, from, leaf_size, powers, to,
+                                  jobs);
+        }
 
-        self_t& operator*=(const self_t& other);
+        /**
+        ** Convert the \a len digits from the \a first th, see from_digits,
+        ** on up to \a jobs threads.
+        **/
+        template <typename Digit>
+        static self_t convert_digits(const Digit& digit, index_t first,
+                                     index_t len, std::size_t from,
+                                     std::size_t leaf_size,
+                                     const std::vector<self_t>& powers,
+                                     std::size_t to, std::size_t jobs)
+        {
+            if (len <= leaf_size)
+            {
+                limb_t v = 0;
+                for (index_t i = first + len; i-- > first;)
+                    v = v * from + digit(i);
+                return from_limb(v, to);
+            }
 
-        self_t& operator/=(const self_t& other);
+            // Split at the greatest leaf_size 2^k under len.
+            std::size_t k = 0;
+            while ((leaf_size << (k + 1)) < len)
+                k++;
+            index_t lo_len = leaf_size << k;
 
-        self_t& operator%=(const self_t& other);
+            if (jobs > 1)
+            {
+                auto hi = std::async(std::launch::async, [&]()
+                {
+                    return convert_digits(digit, first + lo_len, len - lo_len,
+                                          from, leaf_size, powers, to,
+                                          jobs / 2);
+                });
+                self_t lo = convert_digits(digit, first, lo_len, from,
+                                           leaf_size, powers, to,
+                                           jobs - jobs / 2);
+                return hi.get() * powers[k] + lo;
+            }
 
-        self_t& pow_inplace(const self_t& exponent);
+            self_t hi = convert_digits(digit, first + lo_len, len - lo_len,
+                                       from, leaf_size, powers, to, 1);
+            self_t lo = convert_digits(digit, first, lo_len, from, leaf_size,
+                                       powers, to, 1);
+            return hi * powers[k] + lo;
+        }
 
-        self_t& sqrt_inplace();
+        /**
+        ** Add the \a na elements at \a a to the \a nr elements at \a r, with
+        ** \a na <= \a nr, and return the outgoing carry.
+        **/
+        elt_t add_in(elt_t* r, size_t nr, const elt_t* a, size_t na) const
+        {
+            elt_t carry = 0;
+            for (size_t i = 0; i < nr && (i < na || carry); i++)
+            {
+                elt_t add = i < na ? a[i] : 0;
+                if constexpr (is_packed)
+                {
+                    limb_t sum = r[i] + carry;
+                    carry = sum < carry;
+                    sum += add;
+                    carry |= sum < add;
+                    r[i] = sum;
+                }
+                else
+                {
+                    std::size_t sum = std::size_t(r[i]) + add + carry;
+                    carry = sum >= radix();
+                    r[i] = carry ? sum - radix() : sum;
+                }
+            }
+            return carry;
+        }
 
-        self_t& log_inplace(const self_t& base);
+        /**
+        ** Subtract the \a na elements at \a a from the \a nr elements at
+        ** \a r, \a r being the greater.
+        **/
+        void sub_in(elt_t* r, size_t nr, const elt_t* a, size_t na) const
+        {
+            elt_t borrow = 0;
+            for (size_t i = 0; i < nr && (i < na || borrow); i++)
+            {
+                elt_t sub = i < na ? a[i] : 0;
+                if constexpr (is_packed)
+                {
+                    limb_t diff = r[i] - sub;
+                    limb_t b = r[i] < sub;
+                    b |= diff < borrow;
+                    r[i] = diff - borrow;
+                    borrow = b;
+                }
+                else
+                {
+                    std::size_t sum = std::size_t(r[i]) + radix() - sub - borrow;
+                    borrow = sum < radix();
+                    r[i] = borrow ? sum : sum - radix();
+                }
+            }
+        }
 
-        bool operator>(const self_t& other) const;
+        /**
+        ** Schoolbook product of the \a na elements at \a a by the \a nb
+        ** elements at \a b, added to the \a na + \a nb elements at \a out.
+        **/
+        void mul_school(const elt_t* a, size_t na, const elt_t* b, size_t nb,
+                        elt_t* out) const
+        {
+            if constexpr (is_packed)
+            {
+                // 64-bit limbs, with 128-bit partial products.
+                for (size_t i = 0; i < na; i++)
+                {
+                    limb_t carry = 0;
+                    for (size_t j = 0; j < nb; j++)
+                    {
+                        dlimb_t prod = static_cast<dlimb_t>(a[i]) * b[j]
+                                       + out[i + j] + carry;
+                        out[i + j] = static_cast<limb_t>(prod);
+                        carry = static_cast<limb_t>(prod >> limb_bits);
+                    }
+                    out[i + nb] = carry;
+                }
+                return;
+            }
 
-        bool operator==(const self_t& other) const;
-        ///@}
+            // With a static radix, the divisions below are by a constant and
+            // compile to a multiply-shift.
+            const std::size_t base = radix();
+            if (base <= (1u << 24) && std::min(na, nb) < karatsuba_threshold)
+            {
+                // Column sums of at most 32 products under 2^48 fit in 64
+                // bits: a single division per digit of the result.
+                size_t carry = 0;
+                for (size_t k = 0; k < na + nb; k++)
+                {
+                    size_t sum = carry + out[k];
+                    size_t first = k >= nb ? k - nb + 1 : 0;
+                    for (size_t i = first; i < na && i <= k; i++)
+                        sum += size_t(a[i]) * b[k - i];
+                    carry = sum / base;
+                    out[k] = sum % base;
+                }
+                return;
+            }
+            for (size_t i = 0; i < na; i++)
+            {
+                size_t carry = 0;
+                size_t n1 = a[i];
 
-        /// Returns true if the number is not 0, false otherwise
-        explicit operator bool() const;
+                for (size_t j = 0; j < nb; j++)
+                {
+                    size_t sum = n1 * b[j] + out[i + j] + carry;
 
-    private:
-        
-        std::vector<digit_t> number_;
+                    carry = sum / base;
+                    out[i + j] = sum % base;
+                }
+
+                out[i + nb] = carry;
+            }
+        }
+
+        /**
+        ** Karatsuba product of the \a na elements at \a a by the \a nb
+        ** elements at \a b, into the \a na + \a nb zeroed elements at \a out.
+        **
+        ** With a = a1 X + a0 and b = b1 X + b0, a b = a1 b1 X^2 + a0 b0
+        **   + ((a0 + a1)(b0 + b1) - a0 b0 - a1 b1) X: three half products.
+        **/
+        void mul_karatsuba(const elt_t* a, size_t na, const elt_t* b,
+                           size_t nb, elt_t* out) const
+        {
+            if (na < nb)
+            {
+                std::swap(a, b);
+                std::swap(na, nb);
+            }
+            if (nb < karatsuba_threshold)
+                return mul_school(a, na, b, nb, out);
+
+            if (2 * nb <= na)
+            {
+                // Unbalanced operands: multiply b by slices of a.
+                digits_t tmp(2 * nb);
+                for (size_t i = 0; i < na; i += nb)
+                {
+                    size_t len = std::min(nb, na - i);
+                    std::fill(tmp.begin(), tmp.end(), 0);
+                    mul_karatsuba(a + i, len, b, nb, tmp.data());
+                    add_in(out + i, na + nb - i, tmp.data(), len + nb);
+                }
+                return;
+            }
+
+            size_t m = na / 2;
+            mul_karatsuba(a, m, b, m, out);
+            mul_karatsuba(a + m, na - m, b + m, nb - m, out + 2 * m);
+
+            digits_t sa(na - m + 1);
+            digits_t sb(na - m + 1);
+            std::copy(a + m, a + na, sa.begin());
+            std::copy(b + m, b + nb, sb.begin());
+            sa[na - m] = add_in(sa.data(), na - m, a, m);
+            sb[na - m] = add_in(sb.data(), na - m, b, m);
+
+            digits_t mid(sa.size() + sb.size());
+            mul_karatsuba(sa.data(), sa.size(), sb.data(), sb.size(),
+                          mid.data());
+            sub_in(mid.data(), mid.size(), out, 2 * m);
+            sub_in(mid.data(), mid.size(), out + 2 * m, na + nb - 2 * m);
+            add_in(out + m, na + nb - m, mid.data(),
+                   std::min(mid.size(), na + nb - m));
+        }
+
+        /// Base of the number, resolved at compile time when possible.
+        constexpr std::size_t radix() const
+        {
+            if constexpr (Radix != 0)
+                return Radix;
+            else
+                return base_;
+        }
+
+        /**
+        ** \throw std::invalid_argument if \a header doesn't describe a BigNum
+        ** of this type.
+        **/
+        static void check_header(const BigNumHeader& header)
+        {
+            if (std::memcmp(header.magic, "BNUM", 4) || header.version != 2
+                || header.limb_width != sizeof(elt_t) || header.big_endian > 1
+                || header.packed != is_packed || header.base < 2
+                || header.base - 1 > std::numeric_limits<T>::max())
+                throw std::invalid_argument("ia in check_header");
+            check_radix(header.base);
+        }
+
+        /**
+        ** \throw std::invalid_argument if the limbs at \a limbs, described by
+        ** \a header, hold a digit over the base or a leading zero limb.
+        **/
+        static void check_limbs(const elt_t* limbs, const BigNumHeader& header)
+        {
+            // 0 has no limbs.
+            if (header.count && !limbs[header.count - 1])
+                throw std::invalid_argument("ia in check_limbs");
+            if constexpr (!is_packed)
+                for (std::size_t i = 0; i < header.count; i++)
+                    if (limbs[i] >= header.base)
+                        throw std::invalid_argument("ia in check_limbs");
+        }
+
+        /// \throw std::invalid_argument if \a base differs from \a Radix.
+        static void check_radix(std::size_t base)
+        {
+            if constexpr (Radix != 0)
+                if (base != Radix)
+                    throw std::invalid_argument("base differs from radix");
+        }
+
+        /// \throw std::invalid_argument if \a other has another base.
+        void check_base(const self_t& other) const
+        {
+            if constexpr (Radix == 0)
+                if (base_ != other.base_)
+                    throw std::invalid_argument("not same base");
+        }
+
+        /// Remove the leading 0s, 0 being represented by no digits.
+        void strip_leading_zeros()
+        {
+            strip_leading_zeros(number_);
+        }
+
+        static void strip_leading_zeros(digits_t& digits)
+        {
+            while (!digits.empty() && digits.back() == 0)
+                digits.pop_back();
+        }
+
+        /// Digits, least significant first (limbs in packed mode).
+        digits_t number_;
         std::size_t base_;
         bool is_positive_;
         
@@ -0,0 +1,704 @@
+#pragma once
+
+#include <algorithm> // max
+#include <cmath> // pow
+#include <cstdint> // uint32_t
+#include <memory> // shared_ptr
+#include <stdexcept> // length_error
+#include <unordered_map>
+#include <utility> // pair
+#include <vector>
+
+#include "ast-node.hh"
+#include "thread-pool.hh"
+
+namespace bistro
+{
+    /**
+    ** Instruction of a Bytecode.
+    **
+    ** PUSH_LIT pushes a literal, NEG replaces the value on top of the stack
+    ** by its opposite, and the others up to POW replace the two values on top
+    ** by the result of their operator, whose right operand was computed first
+    ** if they are swapped. SAVE pops the value on top into a register, and
+    ** LOAD pushes the value of a register.
+    **/
+    enum class OpCode : uint8_t
+    {
+        PUSH_LIT,
+        ADD,
+        SUB,
+        MUL,
+        DIV,
+        MOD,
+        POW,
+        NEG,
+        LOAD,
+        SAVE,
+    };
+
+    /**
+    ** AST compiled to a linear program for a stack machine.
+    **
+    ** The instructions are a post-order of the AST: each one pops its
+    ** operands from the stack and pushes its result. The program doesn't
+    ** depend on the AST once compiled, but for the memos of its shared nodes
+    ** (see ASTNode::get_memo), and may be run several times.
+    **
+    ** The operand needing the more memory is computed first, as in the
+    ** Sethi-Ullman numbering, so that the values of the other operand are
+    ** not alive meanwhile. An operand is dropped once used, and a sum reuses
+    ** the digits of an operand it owns in place.
+    **
+    ** The instructions of a subtree are contiguous, so each instruction
+    ** records where its subtree begins, and an estimate of the cost of its
+    ** evaluation: the binary operators whose operands are both expensive
+    ** are fork points, where run evaluates the operands in parallel.
+    **
+    ** The number of digits of each value is bounded while compiling (see
+    ** result_digits), and so is the memory the values computed need at once
+    ** when run sequentially, to be checked against a budget before running.
+    **
+    ** The shared nodes of the AST (see ASTNode::is_shared) are computed once,
+    ** before the rest of the program, and saved in registers. Their values
+    ** are kept in their memo, so that the programs of other ASTs sharing
+    ** them reuse them instead of computing them again.
+    **/
+    template <typename BigNum, typename Base>
+    class Bytecode
+    {
+    public:
+        /// Shared_ptr to a BigNum.
+        using num_t = std::shared_ptr<BigNum>;
+
+        /// AST node.
+        using ast_t = ASTNode<BigNum, Base>;
+
+        /**
+        ** An instruction, and the index of its literal for a PUSH_LIT, of
+        ** its register for a LOAD or a SAVE, or whether the operands of a
+        ** binary operator are swapped.
+        **/
+        struct Instruction
+        {
+            OpCode op;
+            uint32_t arg;
+        };
+
+        /**
+        ** Compile the AST \a ast.
+        **
+        ** The AST is walked with an explicit stack, so that deep trees do not
+        ** overflow the call stack.
+        **/
+        static Bytecode compile(const ast_t& ast)
+        {
+            Bytecode code;
+            // Register of each shared node, in post-order.
+            std::unordered_map<const ast_t*, uint32_t> regs;
+            std::vector<const ast_t*> shared;
+            std::vector<std::pair<const ast_t*, bool>> todo = {{&ast, false}};
+            std::vector<const ast_t*> operands;
+            while (!todo.empty())
+            {
+                auto [node, ready] = todo.back();
+                todo.pop_back();
+                if (ready)
+                {
+                    regs[node] = shared.size();
+                    shared.push_back(node);
+                    continue;
+                }
+                bool save = node != &ast && node->is_shared();
+                if (save && !regs.try_emplace(node, none).second)
+                    continue;
+                if (save)
+                    todo.emplace_back(node, true);
+                operands.clear();
+                node->get_operands(operands);
+                for (auto it = operands.rbegin(); it != operands.rend(); ++it)
+                    todo.emplace_back(*it, false);
+            }
+
+            for (uint32_t r = 0; r < shared.size(); r++)
+            {
+                code.emit(*shared[r], regs);
+                code.push_save(r);
+                code.memos_.push_back(shared[r]->get_memo());
+            }
+            code.emit(ast, regs);
+            code.index_forks();
+            return code;
+        }
+
+        /// Append a push of \a num.
+        void push_literal(const num_t& num)
+        {
+            double size = std::max<double>(num->get_num_digits(), 1);
+            radix_ = num->get_base_num();
+            shapes_.push_back({uint32_t(code_.size()), size, 0,
+                               value_or(*num, HUGE_VAL), 0});
+            begin_.push_back(code_.size());
+            cost_.push_back(0);
+            code_.push_back({OpCode::PUSH_LIT, uint32_t(literals_.size())});
+            literals_.push_back(num);
+            if (++depth_ > max_depth_)
+                max_depth_ = depth_;
+        }
+
+        /**
+        ** Append the binary operator \a op, the value on top of the stack
+        ** being its left operand if \a swapped, its right operand otherwise.
+        **/
+        void push_binop(OpType op, bool swapped = false)
+        {
+            static const OpCode codes[] = {
+                OpCode::ADD, OpCode::SUB, OpCode::MUL,
+                OpCode::DIV, OpCode::MOD, OpCode::POW,
+            };
+            Shape top = shapes_.back();
+            shapes_.pop_back();
+            Shape& res = shapes_.back();
+            const Shape lhs = swapped ? top : res;
+            const Shape rhs = swapped ? res : top;
+            if (lhs.cost >= fork_cost && rhs.cost >= fork_cost)
+                forks_.push_back(code_.size());
+            double size = result_digits(op, lhs.size, rhs.size, rhs.value);
+            res.cost = lhs.cost + rhs.cost;
+            switch (op)
+            {
+            case OpType::PLUS:
+            case OpType::MINUS:
+                res.cost += size;
+                break;
+            case OpType::TIMES:
+                res.cost += lhs.size * rhs.size;
+                break;
+            case OpType::DIVIDE:
+            case OpType::MODULO:
+                res.cost += std::max(lhs.size - rhs.size + 1, 1.) * rhs.size;
+                break;
+            default:
+                res.cost += size * size;
+            }
+            // The operands are alive until the result is computed.
+            peak_ = std::max(peak_, live_ + size);
+            live_ += size - lhs.owned - rhs.owned;
+            res.size = size;
+            res.owned = size;
+            res.value = std::pow(double(radix_), size);
+            begin_.push_back(res.begin);
+            cost_.push_back(res.cost);
+            code_.push_back({codes[static_cast<int>(op)], swapped});
+            depth_--;
+        }
+
+        /**
+        ** Append a pop of the value on top into the register \a reg, the
+        ** registers being saved in order.
+        **/
+        void push_save(uint32_t reg)
+        {
+            if (reg >= reg_sizes_.size())
+                reg_sizes_.resize(reg + 1);
+            reg_sizes_[reg] = shapes_.back().size;
+            begin_.push_back(shapes_.back().begin);
+            cost_.push_back(shapes_.back().cost);
+            shapes_.pop_back();
+            saves_.push_back(code_.size());
+            code_.push_back({OpCode::SAVE, reg});
+            depth_--;
+        }
+
+        /// Append a push of the value of the register \a reg.
+        void push_load(uint32_t reg)
+        {
+            double size = reg_sizes_.at(reg);
+            shapes_.push_back({uint32_t(code_.size()), size, 0,
+                               std::pow(double(radix_), size), 0});
+            begin_.push_back(code_.size());
+            cost_.push_back(0);
+            code_.push_back({OpCode::LOAD, reg});
+            if (++depth_ > max_depth_)
+                max_depth_ = depth_;
+        }
+
+        /// Append the unary operator \a op.
+        void push_unop(OpType op)
+        {
+            if (op != OpType::MINUS)
+                return;
+            Shape& operand = shapes_.back();
+            operand.cost += operand.size;
+            // A value that is not owned is copied.
+            if (!operand.owned)
+            {
+                operand.owned = operand.size;
+                live_ += operand.size;
+                peak_ = std::max(peak_, live_);
+            }
+            begin_.push_back(operand.begin);
+            cost_.push_back(operand.cost);
+            code_.push_back({OpCode::NEG, 0});
+        }
+
+        /// Get the instructions.
+        const std::vector<Instruction>& get_code() const
+        {
+            return code_;
+        }
+
+        /**
+        ** Bound on the memory used at once by the values computed, the
+        ** literals aside, in a sequential run.
+        **/
+        double get_peak_bytes() const
+        {
+            return peak_ * BigNum::digit_bytes();
+        }
+
+        /**
+        ** Check that the program can be run within \a budget bytes.
+        **
+        ** \throw std::length_error if get_peak_bytes exceeds \a budget.
+        **/
+        void check_budget(double budget) const
+        {
+            if (get_peak_bytes() > budget)
+                throw std::length_error("memory budget exceeded");
+        }
+
+        /**
+        ** Run the program, and return the value left on the stack.
+        **
+        ** The literals are used in place: a value is only copied when
+        ** negated. A shared node already computed, by a run of this program
+        ** or of another one, is not computed again. With a \a pool, the
+        ** operands of the fork points are evaluated on its workers.
+        **/
+        BigNum run(ThreadPool* pool = nullptr) const
+        {
+            auto base = literals_.front()->get_base_num();
+            std::vector<num_t> values(saves_.size());
+            std::vector<Slot> regs;
+            regs.reserve(saves_.size());
+            uint32_t first = 0;
+            for (size_t r = 0; r < saves_.size(); first = saves_[r++] + 1)
+            {
+                if (memos_[r])
+                    values[r] = memos_[r]->get();
+                if (!values[r])
+                {
+                    values[r] = std::make_shared<BigNum>(
+                        run_range(first, saves_[r], pool, regs));
+                    if (memos_[r])
+                        memos_[r]->set(values[r]);
+                }
+                regs.push_back({values[r].get(), BigNum(base)});
+            }
+            return run_range(first, code_.size(), pool, regs);
+        }
+
+    private:
+        /// A value on the stack: a literal or a register, or a result it owns.
+        struct Slot
+        {
+            const BigNum* lit;
+            BigNum own;
+
+            const BigNum& get() const
+            {
+                return lit ? *lit : own;
+            }
+        };
+
+        /// Estimate of the evaluation of a subtree, while compiling.
+        struct Need
+        {
+            /// Estimated number of digits, and bound on the value.
+            double size;
+            double value;
+            /// Number of digits of the value if computed, 0 otherwise.
+            double owned;
+            /// Digits of the values computed at once by the evaluation.
+            double peak;
+            /// Number of nodes of the subtree.
+            uint32_t nodes;
+            /// Whether the right operand is better computed first.
+            bool swapped;
+        };
+
+        /**
+        ** Estimate the evaluation of each node of the subtree \a root, the
+        ** shared nodes below it being loaded from their register in \a regs,
+        ** in pre-order: the operands of the node i are the node i + 1 and
+        ** the node after its subtree.
+        **/
+        std::vector<Need>
+        estimate(const ast_t& root,
+                 const std::unordered_map<const ast_t*, uint32_t>& regs)
+        {
+            std::vector<Need> needs;
+            // Nodes to visit, and their index once visited.
+            std::vector<std::pair<const ast_t*, uint32_t>> todo = {
+                {&root, none}};
+            std::vector<const ast_t*> operands;
+            while (!todo.empty())
+            {
+                auto [node, index] = todo.back();
+                todo.pop_back();
+                if (index == none)
+                {
+                    index = needs.size();
+                    needs.push_back({1, 0, 0, 0, 1, false});
+                    if (node == &root || !node->is_shared())
+                    {
+                        todo.emplace_back(node, index);
+                        operands.clear();
+                        node->get_operands(operands);
+                        for (auto it = operands.rbegin();
+                             it != operands.rend(); ++it)
+                            todo.emplace_back(*it, none);
+                        continue;
+                    }
+                    // A register, computed beforehand.
+                    needs[index].size = reg_sizes_.at(regs.at(node));
+                    needs[index].value = std::pow(double(radix_),
+                                                  needs[index].size);
+                    continue;
+                }
+
+                Need& need = needs[index];
+                need.nodes = needs.size() - index;
+                if (node->get_kind() == NodeKind::NUMBER)
+                {
+                    auto num = node->get_num();
+                    radix_ = num->get_base_num();
+                    need.size = std::max<double>(num->get_num_digits(), 1);
+                    need.value = value_or(*num, HUGE_VAL);
+                    continue;
+                }
+                const Need& lhs = needs[index + 1];
+                if (node->get_kind() == NodeKind::UNOP)
+                {
+                    need = lhs;
+                    need.nodes = needs.size() - index;
+                    need.swapped = false;
+                    // A value that is not owned is copied.
+                    if (node->get_op() == OpType::MINUS && !lhs.owned)
+                    {
+                        need.owned = lhs.size;
+                        need.peak = std::max(lhs.peak, lhs.size);
+                    }
+                    continue;
+                }
+                const Need& rhs = needs[index + 1 + lhs.nodes];
+                need.size = result_digits(node->get_op(), lhs.size, rhs.size,
+                                          rhs.value);
+                need.value = std::pow(double(radix_), need.size);
+                need.owned = need.size;
+                // The operand computed first is alive while the other one
+                // is computed, and both until the result is.
+                double both = lhs.owned + rhs.owned + need.size;
+                double left = std::max(lhs.peak, lhs.owned + rhs.peak);
+                double right = std::max(rhs.peak, rhs.owned + lhs.peak);
+                need.swapped = right < left;
+                need.peak = std::max(std::min(left, right), both);
+            }
+            return needs;
+        }
+
+        /**
+        ** Append the instructions of the subtree \a root, the shared nodes
+        ** below it being loaded from their register in \a regs. The
+        ** operand of a binary operator needing the more memory is computed
+        ** first, see estimate.
+        **/
+        void emit(const ast_t& root,
+                  const std::unordered_map<const ast_t*, uint32_t>& regs)
+        {
+            std::vector<Need> needs = estimate(root, regs);
+            // Nodes to visit, their index in needs, and whether their
+            // operands are compiled.
+            struct Visit
+            {
+                const ast_t* node;
+                uint32_t index;
+                bool ready;
+            };
+            std::vector<Visit> todo = {{&root, 0, false}};
+            std::vector<const ast_t*> operands;
+            while (!todo.empty())
+            {
+                auto [node, index, ready] = todo.back();
+                todo.pop_back();
+                const Need& need = needs[index];
+                if (ready && node->get_kind() == NodeKind::BINOP)
+                {
+                    push_binop(node->get_op(), need.swapped);
+                    continue;
+                }
+                if (ready)
+                {
+                    node->compile(*this);
+                    continue;
+                }
+                if (node != &root && node->is_shared())
+                {
+                    push_load(regs.at(node));
+                    continue;
+                }
+                todo.push_back({node, index, true});
+                operands.clear();
+                node->get_operands(operands);
+                if (operands.empty())
+                    continue;
+                uint32_t lhs = index + 1;
+                if (operands.size() == 1)
+                {
+                    todo.push_back({operands[0], lhs, false});
+                    continue;
+                }
+                Visit left = {operands[0], lhs, false};
+                Visit right = {operands[1], lhs + needs[lhs].nodes, false};
+                todo.push_back(need.swapped ? left : right);
+                todo.push_back(need.swapped ? right : left);
+            }
+        }
+
+        /// Shape of a value on the stack, while compiling.
+        struct Shape
+        {
+            /// First instruction of the subtree.
+            uint32_t begin;
+            /// Estimated number of digits.
+            double size;
+            /// Estimated cost of the evaluation, in digit operations.
+            double cost;
+            /// Bound on the value.
+            double value;
+            /// Number of digits of the value if computed, 0 for a literal.
+            double owned;
+        };
+
+        /// Minimal cost of both operands of a fork point.
+        static constexpr double fork_cost = 1 << 17;
+
+        /// No fork point.
+        static constexpr uint32_t none = uint32_t(-1);
+
+        /**
+        ** Index the fork points by the first instruction of their subtree:
+        ** fork_at_ gives the outermost one, and fork_next_ the next one
+        ** beginning at the same instruction. Called once compiled.
+        **/
+        void index_forks()
+        {
+            shapes_ = {};
+            reg_sizes_ = {};
+            // Without fork points, the program is only run sequentially.
+            if (forks_.empty())
+            {
+                begin_ = {};
+                cost_ = {};
+                return;
+            }
+            fork_at_.assign(code_.size(), none);
+            fork_next_.assign(code_.size(), none);
+            for (auto root : forks_)
+            {
+                fork_next_[root] = fork_at_[begin_[root]];
+                fork_at_[begin_[root]] = root;
+            }
+        }
+
+        /**
+        ** Evaluate the subtree of root \a root, a fork point, in parallel.
+        **
+        ** The expensive binary operations of its spine of operands computed
+        ** first, usually the left ones, are gathered, so
+        ** that a chain of operations, like a sum of products, is evaluated
+        ** with a single parallel loop over its operands, and folded
+        ** afterwards.
+        **/
+        BigNum run_fork(uint32_t root, ThreadPool& pool,
+                        std::vector<Slot>& regs) const
+        {
+            std::vector<uint32_t> spine = {root};
+            for (uint32_t r = root; ; )
+            {
+                uint32_t lhs = begin_[r - 1] - 1;
+                OpCode op = code_[lhs].op;
+                if (op < OpCode::ADD || op > OpCode::POW
+                    || cost_[lhs] < fork_cost)
+                    break;
+                spine.push_back(r = lhs);
+            }
+            // The right operands of the spine, then its leftmost operand.
+            auto base = literals_.front()->get_base_num();
+            std::vector<BigNum> values;
+            values.reserve(spine.size() + 1);
+            for (size_t i = 0; i <= spine.size(); i++)
+                values.emplace_back(base);
+            pool.parallel_for(values.size(), [&](size_t i)
+            {
+                if (i < spine.size())
+                    values[i] = run_range(begin_[spine[i] - 1], spine[i],
+                                          &pool, regs);
+                else
+                    values[i] = run_range(begin_[spine.back()],
+                                          begin_[spine.back() - 1], &pool,
+                                          regs);
+            });
+            BigNum res = std::move(values.back());
+            for (size_t i = spine.size(); i-- > 0;)
+            {
+                const Instruction& instr = code_[spine[i]];
+                res = instr.arg ? run_op(instr.op, values[i], res)
+                                : run_op(instr.op, res, values[i]);
+            }
+            return res;
+        }
+
+        /// Apply the binary instruction \a op to \a a and \a b.
+        static BigNum run_op(OpCode op, const BigNum& a, const BigNum& b)
+        {
+            switch (op)
+            {
+            case OpCode::ADD:
+                return a + b;
+            case OpCode::SUB:
+                return a - b;
+            case OpCode::MUL:
+                return a * b;
+            case OpCode::DIV:
+                return a / b;
+            case OpCode::MOD:
+                return a % b;
+            default:
+                return a.pow(b);
+            }
+        }
+
+        /**
+        ** Apply the binary instruction \a op to the values \a a and \a b,
+        ** into \a a. A sum is computed in place in an operand it owns.
+        **/
+        static void run_op(OpCode op, Slot& a, Slot& b)
+        {
+            if (op == OpCode::ADD || op == OpCode::SUB)
+            {
+                if (!a.lit)
+                {
+                    if (op == OpCode::ADD)
+                        a.own += b.get();
+                    else
+                        a.own -= b.get();
+                    return;
+                }
+                if (!b.lit)
+                {
+                    // a - b = -(b - a)
+                    if (op == OpCode::ADD)
+                        b.own += *a.lit;
+                    else
+                    {
+                        b.own -= *a.lit;
+                        b.own.set_positive(!b.own.is_positive());
+                    }
+                    a = std::move(b);
+                    return;
+                }
+            }
+            a.own = run_op(op, a.get(), b.get());
+            a.lit = nullptr;
+        }
+
+        /**
+        ** Run the instructions [\a first, \a last), which compute a single
+        ** value without saving it, with the registers \a regs. With a
+        ** \a pool, the fork points are run with run_fork.
+        **/
+        BigNum run_range(uint32_t first, uint32_t last, ThreadPool* pool,
+                         std::vector<Slot>& regs) const
+        {
+            std::vector<Slot> stack;
+            stack.reserve(max_depth_);
+            for (uint32_t i = first; i < last; i++)
+            {
+                if (pool && !fork_at_.empty())
+                {
+                    auto root = fork_at_[i];
+                    while (root != none && root >= last)
+                        root = fork_next_[root];
+                    if (root != none)
+                    {
+                        stack.push_back({nullptr,
+                                         run_fork(root, *pool, regs)});
+                        i = root;
+                        continue;
+                    }
+                }
+                const Instruction& instr = code_[i];
+                if (instr.op == OpCode::PUSH_LIT || instr.op == OpCode::LOAD)
+                {
+                    const BigNum* lit = instr.op == OpCode::LOAD
+                        ? &regs[instr.arg].get()
+                        : literals_[instr.arg].get();
+                    stack.push_back({lit, BigNum(lit->get_base_num())});
+                    continue;
+                }
+                Slot& top = stack.back();
+                if (instr.op == OpCode::NEG)
+                {
+                    if (top.lit)
+                        top.own = top.lit->clone();
+                    top.lit = nullptr;
+                    top.own.set_positive(!top.own.is_positive());
+                    continue;
+                }
+
+                Slot last = std::move(top);
+                stack.pop_back();
+                Slot& first = stack.back();
+                if (instr.arg)
+                {
+                    run_op(instr.op, last, first);
+                    first = std::move(last);
+                }
+                else
+                    run_op(instr.op, first, last);
+            }
+            Slot& res = stack.back();
+            return res.lit ? res.lit->clone() : std::move(res.own);
+        }
+
+        std::vector<Instruction> code_;
+        std::vector<num_t> literals_;
+        /// Depth of the stack after the instructions, and its maximum.
+        std::size_t depth_ = 0;
+        std::size_t max_depth_ = 0;
+        /// First instruction of the subtree of each instruction.
+        std::vector<uint32_t> begin_;
+        /// Estimated cost of the subtree of each instruction.
+        std::vector<float> cost_;
+        /// Shapes of the values on the stack, and sizes of the registers,
+        /// while compiling.
+        std::vector<Shape> shapes_;
+        std::vector<double> reg_sizes_;
+        /// SAVE of each register, ending the instructions computing it, and
+        /// memo of its node.
+        std::vector<uint32_t> saves_;
+        std::vector<std::shared_ptr<Memo<BigNum>>> memos_;
+        /// Base of the literals.
+        std::size_t radix_ = 2;
+        /// Digits of the values computed on the stack and in the registers,
+        /// and their maximum.
+        double live_ = 0;
+        double peak_ = 0;
+        /// Fork points, and their index, see index_forks.
+        std::vector<uint32_t> forks_;
+        std::vector<uint32_t> fork_at_;
+        std::vector<uint32_t> fork_next_;
+    };
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#if defined(__SSE2__)
+# include <immintrin.h>
+#endif
+
+namespace bistro
+{
+  namespace parser
+  {
+    /// Whether \a c ends a run of digits: an operator, a parenthesis or '\n'.
+    inline bool ends_digit_run(char c)
+    {
+      return c == '+' || c == '-' || c == '*' || c == '/' || c == '%'
+        || c == '(' || c == ')' || c == '\n';
+    }
+
+#if defined(__AVX2__)
+    /// Mask of the bytes of \a v ending a run of digits.
+    inline unsigned digit_run_mask(__m256i v)
+    {
+      // '(', ')', '*' and '+' are contiguous: one unsigned range check.
+      __m256i r = _mm256_sub_epi8(v, _mm256_set1_epi8('('));
+      __m256i m = _mm256_min_epu8(r, _mm256_set1_epi8(3));
+      m = _mm256_cmpeq_epi8(m, r);
+      m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('-')));
+      m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('/')));
+      m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('%')));
+      m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+      return _mm256_movemask_epi8(m);
+    }
+#elif defined(__SSE2__)
+    /// Mask of the bytes of \a v ending a run of digits.
+    inline unsigned digit_run_mask(__m128i v)
+    {
+      // '(', ')', '*' and '+' are contiguous: one unsigned range check.
+      __m128i r = _mm_sub_epi8(v, _mm_set1_epi8('('));
+      __m128i m = _mm_cmpeq_epi8(_mm_min_epu8(r, _mm_set1_epi8(3)), r);
+      m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('-')));
+      m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('/')));
+      m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('%')));
+      m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+      return _mm_movemask_epi8(m);
+    }
+#endif
+
+    /**
+    ** Return the end of the run of digits starting at \a p, i.e. the first
+    ** byte of [\a p, \a end) ending a run, or \a end.
+    **
+    ** The bytes are compared to the reserved characters 32 at a time with
+    ** AVX2, 16 at a time with SSE2, then one by one.
+    **/
+    inline const char* find_digit_run_end(const char* p, const char* end)
+    {
+#if defined(__AVX2__)
+      for (; end - p >= 32; p += 32)
+      {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        if (unsigned mask = digit_run_mask(v))
+          return p + __builtin_ctz(mask);
+      }
+#elif defined(__SSE2__)
+      for (; end - p >= 16; p += 16)
+      {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        if (unsigned mask = digit_run_mask(v))
+          return p + __builtin_ctz(mask);
+      }
+#endif
+      while (p != end && !ends_digit_run(*p))
+        ++p;
+      return p;
+    }
+  }
+}
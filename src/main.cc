@@ -1,30 +1,228 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
-#include "ast-factory.hh"
+#include <memory>
+#include <string>
+#include <vector>
+#include "ast-shared.hh"
 #include "parse-driver.hh"
+#include "server.hh"
+#include "thread-pool.hh"
 #include "bignum.hh"
 #include "base.hh"
 
+/**
+** Parse \a str, a number optionally followed by a K, M or G suffix, into
+** \a res. Return false if \a str is not such a number.
+**/
+static bool parse_size(const char* str, double& res)
+{
+    // std::stoul skips blanks and takes a sign, e.g. "-1" as 2^64 - 1.
+    if (!std::strspn(str, "0123456789"))
+        return false;
+    try
+    {
+        size_t end;
+        res = std::stoul(str, &end);
+        const char* suffix = std::strchr("KMG", str[end]);
+        if (str[end] && suffix)
+            for (auto s = "KMG"; s <= suffix; s++)
+                res *= 1024;
+        return !str[end] || (suffix && !str[end + 1]);
+    }
+    catch (std::exception&)
+    {
+        return false;
+    }
+}
+
+/// Greatest number of threads accepted by --jobs.
+static constexpr size_t max_jobs = 256;
 
+/**
+** Parse \a str, a number of threads from 1 to max_jobs in decimal, into
+** \a res. Return false if \a str is not such a number.
+**/
+static bool parse_jobs(const char* str, size_t& res)
+{
+    if (!*str || str[std::strspn(str, "0123456789")])
+        return false;
+    try
+    {
+        res = std::stoul(str);
+    }
+    catch (std::exception&)
+    {
+        return false;
+    }
+    return res >= 1 && res <= max_jobs;
+}
 
 int main(int argc, char * argv[])
 {
-    if (argc < 2)
+    // Number of threads, one per core by default, and memory budget of an
+    // evaluation, in bytes, unlimited by default.
+    size_t nb_jobs = 0;
+    double budget = HUGE_VAL;
+    // Socket to serve on, "-" for the standard input and output, and size of
+    // the cache of the values served, in bytes.
+    const char* socket = nullptr;
+    double cache = 64 << 20;
+    int first = 1;
+    bool usage = false;
+    for (; first + 1 < argc && !std::strncmp(argv[first], "--", 2);
+         first += 2)
     {
-        std::cout << "Usage: " << argv[0] << " <file>\n";
+        if (!std::strcmp(argv[first], "--jobs"))
+            usage |= !parse_jobs(argv[first + 1], nb_jobs);
+        else if (!std::strcmp(argv[first], "--budget"))
+            usage |= !parse_size(argv[first + 1], budget);
+        else if (!std::strcmp(argv[first], "--serve"))
+            socket = argv[first + 1];
+        else if (!std::strcmp(argv[first], "--cache"))
+            usage |= !parse_size(argv[first + 1], cache);
+        else
+            usage = true;
+    }
+    if (usage || (argc <= first) == !socket)
+    {
+        std::cout << "Usage: " << argv[0]
+                  << " [--jobs N] [--budget BYTES[K|M|G]] <file>...\n"
+                  << "       " << argv[0]
+                  << " [--jobs N] [--budget BYTES[K|M|G]]"
+                     " [--cache BYTES[K|M|G]] --serve SOCKET|-\n";
         return 2;
     }
-    try
+
+    using driver_t = bistro::parser::ParseDriver;
+    bistro::ThreadPool pool(nb_jobs);
+
+    if (socket)
     {
-        bistro::parser::ParseDriver p(argv[1]);
-        const auto ast = p.parse();
-        ast->eval()->print(std::cout, p.get_base());
-        std::cout << std::endl;
+        bistro::Server server(pool, budget, cache);
+        if (!std::strcmp(socket, "-"))
+        {
+            server.serve(stdin, stdout);
+            return 0;
+        }
+        try
+        {
+            server.listen(socket);
+        }
+        catch (std::exception &e)
+        {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
     }
-    catch (std::exception &e)
+
+    // Each file has its own driver, so they are parsed concurrently.
+    size_t nb_files = argc - first;
+    std::vector<std::unique_ptr<driver_t>> drivers(nb_files);
+    std::vector<std::string> errors(nb_files);
+    pool.parallel_for(nb_files, [&](size_t i)
+    {
+        try
+        {
+            drivers[i] = std::make_unique<driver_t>(argv[first + i]);
+            // Repeated subexpressions are evaluated once.
+            drivers[i]->set_factory<bistro::SharedASTFactory>();
+            drivers[i]->parse();
+        }
+        catch (std::exception &e)
+        {
+            drivers[i] = nullptr;
+            errors[i] = e.what();
+        }
+    });
+
+    // The expressions of all the files are independent, so they are
+    // compiled and evaluated concurrently, and so are the expensive operands
+    // within an expression. The results are output in input order.
+    struct job
+    {
+        const driver_t* driver;
+        const bistro::Evaluator* evaluator;
+        driver_t::node_t ast;
+        std::string result;
+        bool failed;
+    };
+    std::vector<std::unique_ptr<bistro::Evaluator>> evaluators;
+    std::vector<job> jobs;
+    for (const auto& driver : drivers)
+        if (driver)
+        {
+            evaluators.push_back(
+                std::make_unique<bistro::Evaluator>(*driver, pool, budget));
+            driver->visit([&](const auto& program)
+            {
+                for (const auto& ast : program.asts)
+                    jobs.push_back({driver.get(), evaluators.back().get(),
+                                    ast, "", false});
+            });
+        }
+
+    // All the expressions are rewritten, and their shared subtrees computed,
+    // before any is run, so that the subtrees repeated across the
+    // expressions of a file are computed once.
+    pool.parallel_for(jobs.size(), [&](size_t i)
+    {
+        try
+        {
+            jobs[i].ast = jobs[i].evaluator->rewrite(jobs[i].ast);
+        }
+        catch (std::exception &e)
+        {
+            jobs[i].result = e.what();
+            jobs[i].failed = true;
+        }
+    });
+    for (const auto& evaluator : evaluators)
+    {
+        std::vector<driver_t::node_t> asts;
+        for (const auto& job : jobs)
+            if (job.evaluator == evaluator.get() && !job.failed)
+                asts.push_back(job.ast);
+        evaluator->share(asts);
+    }
+    pool.parallel_for(jobs.size(), [&](size_t i)
+    {
+        if (jobs[i].failed)
+            return;
+        try
+        {
+            jobs[i].result = jobs[i].evaluator->run(jobs[i].ast);
+        }
+        catch (std::exception &e)
+        {
+            jobs[i].result = e.what();
+            jobs[i].failed = true;
+        }
+    });
+
+    int status = 0;
+    auto it = jobs.begin();
+    for (size_t i = 0; i < nb_files; i++)
     {
-        std::cerr << e.what() << '\n';
-        return 1;
+        if (!drivers[i])
+        {
+            std::cerr << errors[i] << '\n';
+            status = 1;
+            continue;
+        }
+        for (; it != jobs.end() && it->driver == drivers[i].get(); ++it)
+        {
+            if (it->failed)
+            {
+                std::cerr << it->result << '\n';
+                status = 1;
+            }
+            else
+                std::cout << it->result << '\n';
+        }
     }
+    std::cout << std::flush;
 
-    return 0;
+    return status;
 }
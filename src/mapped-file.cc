@@ -0,0 +1,71 @@
+#include "mapped-file.hh"
+
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace bistro
+{
+  namespace parser
+  {
+    MappedFile::MappedFile(const std::string& filename, size_t padding)
+    {
+      int fd = open(filename.c_str(), O_RDONLY);
+      if (fd < 0)
+        throw std::runtime_error("Could not open file.");
+      struct stat st;
+      if (fstat(fd, &st) < 0)
+      {
+        close(fd);
+        throw std::runtime_error("Could not open file.");
+      }
+      // The size of a pipe or a device is not the size of its content.
+      if (!S_ISREG(st.st_mode))
+      {
+        close(fd);
+        throw std::runtime_error("Could not map file.");
+      }
+      size_ = st.st_size;
+
+      // Reserve zeroed anonymous pages for the file and its padding, then
+      // map the file over the start of it: the padding is then never past
+      // the end of the mapping, even for a file filling its last page.
+      size_t page = sysconf(_SC_PAGESIZE);
+      length_ = (size_ + padding + page - 1) / page * page;
+      void* addr = mmap(nullptr, length_, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (addr == MAP_FAILED)
+      {
+        close(fd);
+        throw std::runtime_error("Could not map file.");
+      }
+      if (size_ && mmap(addr, size_, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+      {
+        munmap(addr, length_);
+        close(fd);
+        throw std::runtime_error("Could not map file.");
+      }
+      close(fd);
+      data_ = static_cast<char*>(addr);
+      madvise(data_, length_, MADV_SEQUENTIAL);
+    }
+
+    MappedFile::~MappedFile()
+    {
+      munmap(data_, length_);
+    }
+
+    char* MappedFile::data()
+    {
+      return data_;
+    }
+
+    size_t MappedFile::size() const
+    {
+      return size_;
+    }
+  }
+}
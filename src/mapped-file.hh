@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace bistro
+{
+  namespace parser
+  {
+    /**
+    ** Read-only file mapped in memory.
+    **
+    ** The file is mapped privately and writable, so that a scanner may
+    ** modify the buffer in place without touching the file. The mapping is
+    ** followed by \a padding zero bytes.
+    **/
+    class MappedFile
+    {
+    public:
+      /**
+      ** Map \a filename, followed by \a padding zero bytes.
+      **
+      ** \throw std::runtime_error if the file can't be opened, or is not a
+      ** regular file.
+      **/
+      MappedFile(const std::string& filename, size_t padding);
+      ~MappedFile();
+
+      MappedFile(const MappedFile&) = delete;
+      MappedFile& operator=(const MappedFile&) = delete;
+
+      /// Start of the mapping.
+      char* data();
+
+      /// Size of the file, without the padding.
+      size_t size() const;
+
+    private:
+      char* data_ = nullptr;
+      size_t size_ = 0;
+      size_t length_ = 0;
+    };
+  }
+}
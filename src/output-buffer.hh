@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+
+namespace bistro
+{
+    /**
+    ** OutputBuffer class.
+    **
+    ** Collects characters in a contiguous buffer and writes them to a stream
+    ** by chunks, instead of one stream insertion per character. The buffer
+    ** is flushed when full and on destruction.
+    **/
+    class OutputBuffer
+    {
+    public:
+        /// Size of a chunk.
+        static constexpr std::size_t chunk_size = 1 << 14;
+
+        /// Buffer the output to \a out.
+        explicit OutputBuffer(std::ostream& out)
+            : out_(out)
+        {
+        }
+
+        OutputBuffer(const OutputBuffer&) = delete;
+        OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+        ~OutputBuffer()
+        {
+            flush();
+        }
+
+        /// Append the character \a c.
+        void put(char c)
+        {
+            if (len_ == chunk_size)
+                flush();
+            buf_[len_++] = c;
+        }
+
+        /// Append the \a n characters at \a s.
+        void write(const char* s, std::size_t n)
+        {
+            if (n > chunk_size - len_)
+            {
+                flush();
+                if (n >= chunk_size)
+                {
+                    out_.write(s, n);
+                    return;
+                }
+            }
+            std::memcpy(buf_ + len_, s, n);
+            len_ += n;
+        }
+
+        /// Write the buffered characters to the stream.
+        void flush()
+        {
+            out_.write(buf_, len_);
+            len_ = 0;
+        }
+
+    private:
+        std::ostream& out_;
+        std::size_t len_ = 0;
+        char buf_[chunk_size];
+    };
+}
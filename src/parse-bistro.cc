@@ -1,8 +1,8 @@
-// A Bison parser, made by GNU Bison 3.2.
+// A Bison parser, made by GNU Bison 3.8.2.
 
 // Skeleton implementation for Bison LALR(1) parsers in C++
 
-// Copyright (C) 2002-2015, 2018 Free Software Foundation, Inc.
+// Copyright (C) 2002-2015, 2018-2021 Free Software Foundation, Inc.
 
 // This program is free software: you can redistribute it and/or modify
 // it under the terms of the GNU General Public License as published by
@@ -15,7 +15,7 @@
 // GNU General Public License for more details.
 
 // You should have received a copy of the GNU General Public License
-// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 // As a special exception, you may create a larger work that contains
 // part or all of the Bison parser skeleton and distribute that work
@@ -30,8 +30,9 @@
 // This special exception was added by the Free Software Foundation in
 // version 2.2 of Bison.
 
-// Undocumented macros, especially those whose name start with YY_,
-// are private implementation details.  Do not rely on them.
+// DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+// especially those whose name start with YY_ or yy_.  They are
+// private implementation details that can be changed or removed.
 
 
 
@@ -54,6 +55,7 @@
 # endif
 #endif
 
+
 // Whether we are compiled with exception support.
 #ifndef YY_EXCEPTIONS
 # if defined __GNUC__ && !defined __EXCEPTIONS
@@ -80,13 +82,10 @@
         {                                                               \
           (Current).begin = (Current).end = YYRHSLOC (Rhs, 0).end;      \
         }                                                               \
-    while (/*CONSTCOND*/ false)
+    while (false)
 # endif
 
 
-// Suppress unused-variable warnings by "using" E.
-#define YYUSE(E) ((void) (E))
-
 // Enable debugging if requested.
 #if YYDEBUG
 
@@ -112,13 +111,13 @@
 # define YY_STACK_PRINT()               \
   do {                                  \
     if (yydebug_)                       \
-      yystack_print_ ();                \
+      yy_stack_print_ ();                \
   } while (false)
 
 #else // !YYDEBUG
 
 # define YYCDEBUG if (false) std::cerr
-# define YY_SYMBOL_PRINT(Title, Symbol)  YYUSE (Symbol)
+# define YY_SYMBOL_PRINT(Title, Symbol)  YY_USE (Symbol)
 # define YY_REDUCE_PRINT(Rule)           static_cast<void> (0)
 # define YY_STACK_PRINT()                static_cast<void> (0)
 
@@ -132,41 +131,44 @@
 #define YYERROR         goto yyerrorlab
 #define YYRECOVERING()  (!!yyerrstatus_)
 
-
 namespace yy {
-#line 138 "src/parse-bistro.cc" // lalr1.cc:512
+#line 136 "src/parse-bistro.cc"
 
   /// Build a parser object.
-  parser::parser (bistro::parser::ParseDriver& p_yyarg)
-    :
+  parser::parser (bistro::parser::ParseDriver& p_yyarg, void* yyscanner_yyarg)
 #if YYDEBUG
-      yydebug_ (false),
+    : yydebug_ (false),
       yycdebug_ (&std::cerr),
+#else
+    :
 #endif
-      p (p_yyarg)
+      p (p_yyarg),
+      yyscanner (yyscanner_yyarg)
   {}
 
   parser::~parser ()
   {}
 
+  parser::syntax_error::~syntax_error () YY_NOEXCEPT YY_NOTHROW
+  {}
 
-  /*---------------.
-  | Symbol types.  |
-  `---------------*/
+  /*---------.
+  | symbol.  |
+  `---------*/
 
 
 
   // by_state.
-  parser::by_state::by_state ()
+  parser::by_state::by_state () YY_NOEXCEPT
     : state (empty_state)
   {}
 
-  parser::by_state::by_state (const by_state& other)
-    : state (other.state)
+  parser::by_state::by_state (const by_state& that) YY_NOEXCEPT
+    : state (that.state)
   {}
 
   void
-  parser::by_state::clear ()
+  parser::by_state::clear () YY_NOEXCEPT
   {
     state = empty_state;
   }
@@ -178,17 +180,17 @@ namespace yy {
     that.clear ();
   }
 
-  parser::by_state::by_state (state_type s)
+  parser::by_state::by_state (state_type s) YY_NOEXCEPT
     : state (s)
   {}
 
-  parser::symbol_number_type
-  parser::by_state::type_get () const
+  parser::symbol_kind_type
+  parser::by_state::kind () const YY_NOEXCEPT
   {
     if (state == empty_state)
-      return empty_symbol;
+      return symbol_kind::S_YYEMPTY;
     else
-      return yystos_[state];
+      return YY_CAST (symbol_kind_type, yystos_[+state]);
   }
 
   parser::stack_symbol_type::stack_symbol_type ()
@@ -197,24 +199,21 @@ namespace yy {
   parser::stack_symbol_type::stack_symbol_type (YY_RVREF (stack_symbol_type) that)
     : super_type (YY_MOVE (that.state), YY_MOVE (that.location))
   {
-    switch (that.type_get ())
+    switch (that.kind ())
     {
-      case 17: // exp
-      case 18: // t
-      case 19: // p
-      case 20: // f
+      case symbol_kind::S_BIGNUM: // "bignum"
+      case symbol_kind::S_exp: // exp
+      case symbol_kind::S_t: // t
+      case symbol_kind::S_p: // p
+      case symbol_kind::S_f: // f
         value.YY_MOVE_OR_COPY< node_t > (YY_MOVE (that.value));
         break;
 
-      case 14: // "bignum"
-        value.YY_MOVE_OR_COPY< std::shared_ptr<num_t> > (YY_MOVE (that.value));
-        break;
-
       default:
         break;
     }
 
-#if defined __cplusplus && 201103L <= __cplusplus
+#if 201103L <= YY_CPLUSPLUS
     // that is emptied.
     that.state = empty_state;
 #endif
@@ -223,45 +222,61 @@ namespace yy {
   parser::stack_symbol_type::stack_symbol_type (state_type s, YY_MOVE_REF (symbol_type) that)
     : super_type (s, YY_MOVE (that.location))
   {
-    switch (that.type_get ())
+    switch (that.kind ())
     {
-      case 17: // exp
-      case 18: // t
-      case 19: // p
-      case 20: // f
+      case symbol_kind::S_BIGNUM: // "bignum"
+      case symbol_kind::S_exp: // exp
+      case symbol_kind::S_t: // t
+      case symbol_kind::S_p: // p
+      case symbol_kind::S_f: // f
         value.move< node_t > (YY_MOVE (that.value));
         break;
 
-      case 14: // "bignum"
-        value.move< std::shared_ptr<num_t> > (YY_MOVE (that.value));
+      default:
+        break;
+    }
+
+    // that is emptied.
+    that.kind_ = symbol_kind::S_YYEMPTY;
+  }
+
+#if YY_CPLUSPLUS < 201103L
+  parser::stack_symbol_type&
+  parser::stack_symbol_type::operator= (const stack_symbol_type& that)
+  {
+    state = that.state;
+    switch (that.kind ())
+    {
+      case symbol_kind::S_BIGNUM: // "bignum"
+      case symbol_kind::S_exp: // exp
+      case symbol_kind::S_t: // t
+      case symbol_kind::S_p: // p
+      case symbol_kind::S_f: // f
+        value.copy< node_t > (that.value);
         break;
 
       default:
         break;
     }
 
-    // that is emptied.
-    that.type = empty_symbol;
+    location = that.location;
+    return *this;
   }
 
-#if defined __cplusplus && __cplusplus < 201103L
   parser::stack_symbol_type&
   parser::stack_symbol_type::operator= (stack_symbol_type& that)
   {
     state = that.state;
-    switch (that.type_get ())
+    switch (that.kind ())
     {
-      case 17: // exp
-      case 18: // t
-      case 19: // p
-      case 20: // f
+      case symbol_kind::S_BIGNUM: // "bignum"
+      case symbol_kind::S_exp: // exp
+      case symbol_kind::S_t: // t
+      case symbol_kind::S_p: // p
+      case symbol_kind::S_f: // f
         value.move< node_t > (that.value);
         break;
 
-      case 14: // "bignum"
-        value.move< std::shared_ptr<num_t> > (that.value);
-        break;
-
       default:
         break;
     }
@@ -284,21 +299,21 @@ namespace yy {
 #if YYDEBUG
   template <typename Base>
   void
-  parser::yy_print_ (std::ostream& yyo,
-                                     const basic_symbol<Base>& yysym) const
+  parser::yy_print_ (std::ostream& yyo, const basic_symbol<Base>& yysym) const
   {
     std::ostream& yyoutput = yyo;
-    YYUSE (yyoutput);
-    symbol_number_type yytype = yysym.type_get ();
-    // Avoid a (spurious) G++ 4.8 warning about "array subscript is
-    // below array bounds".
+    YY_USE (yyoutput);
     if (yysym.empty ())
-      std::abort ();
-    yyo << (yytype < yyntokens_ ? "token" : "nterm")
-        << ' ' << yytname_[yytype] << " ("
-        << yysym.location << ": ";
-    YYUSE (yytype);
-    yyo << ')';
+      yyo << "empty symbol";
+    else
+      {
+        symbol_kind_type yykind = yysym.kind ();
+        yyo << (yykind < YYNTOKENS ? "token" : "nterm")
+            << ' ' << yysym.name () << " ("
+            << yysym.location << ": ";
+        YY_USE (yykind);
+        yyo << ')';
+      }
   }
 #endif
 
@@ -313,7 +328,7 @@ namespace yy {
   void
   parser::yypush_ (const char* m, state_type s, YY_MOVE_REF (symbol_type) sym)
   {
-#if defined __cplusplus && 201103L <= __cplusplus
+#if 201103L <= YY_CPLUSPLUS
     yypush_ (m, stack_symbol_type (s, std::move (sym)));
 #else
     stack_symbol_type ss (s, sym);
@@ -322,7 +337,7 @@ namespace yy {
   }
 
   void
-  parser::yypop_ (int n)
+  parser::yypop_ (int n) YY_NOEXCEPT
   {
     yystack_.pop (n);
   }
@@ -357,21 +372,21 @@ namespace yy {
   parser::state_type
   parser::yy_lr_goto_state_ (state_type yystate, int yysym)
   {
-    int yyr = yypgoto_[yysym - yyntokens_] + yystate;
+    int yyr = yypgoto_[yysym - YYNTOKENS] + yystate;
     if (0 <= yyr && yyr <= yylast_ && yycheck_[yyr] == yystate)
       return yytable_[yyr];
     else
-      return yydefgoto_[yysym - yyntokens_];
+      return yydefgoto_[yysym - YYNTOKENS];
   }
 
   bool
-  parser::yy_pact_value_is_default_ (int yyvalue)
+  parser::yy_pact_value_is_default_ (int yyvalue) YY_NOEXCEPT
   {
     return yyvalue == yypact_ninf_;
   }
 
   bool
-  parser::yy_table_value_is_error_ (int yyvalue)
+  parser::yy_table_value_is_error_ (int yyvalue) YY_NOEXCEPT
   {
     return yyvalue == yytable_ninf_;
   }
@@ -385,7 +400,6 @@ namespace yy {
   int
   parser::parse ()
   {
-    // State.
     int yyn;
     /// Length of the RHS of the rule being reduced.
     int yylen = 0;
@@ -417,37 +431,44 @@ namespace yy {
     yystack_.clear ();
     yypush_ (YY_NULLPTR, 0, YY_MOVE (yyla));
 
-    // A new symbol was pushed on the stack.
+  /*-----------------------------------------------.
+  | yynewstate -- push a new symbol on the stack.  |
+  `-----------------------------------------------*/
   yynewstate:
-    YYCDEBUG << "Entering state " << yystack_[0].state << '\n';
+    YYCDEBUG << "Entering state " << int (yystack_[0].state) << '\n';
+    YY_STACK_PRINT ();
 
     // Accept?
     if (yystack_[0].state == yyfinal_)
-      goto yyacceptlab;
+      YYACCEPT;
 
     goto yybackup;
 
-    // Backup.
+
+  /*-----------.
+  | yybackup.  |
+  `-----------*/
   yybackup:
     // Try to take a decision without lookahead.
-    yyn = yypact_[yystack_[0].state];
+    yyn = yypact_[+yystack_[0].state];
     if (yy_pact_value_is_default_ (yyn))
       goto yydefault;
 
     // Read a lookahead token.
     if (yyla.empty ())
       {
-        YYCDEBUG << "Reading a token: ";
+        YYCDEBUG << "Reading a token\n";
 #if YY_EXCEPTIONS
         try
 #endif // YY_EXCEPTIONS
           {
-            symbol_type yylookahead (yylex (p));
+            symbol_type yylookahead (yylex (p, yyscanner));
             yyla.move (yylookahead);
           }
 #if YY_EXCEPTIONS
         catch (const syntax_error& yyexc)
           {
+            YYCDEBUG << "Caught exception: " << yyexc.what() << '\n';
             error (yyexc);
             goto yyerrlab1;
           }
@@ -455,11 +476,23 @@ namespace yy {
       }
     YY_SYMBOL_PRINT ("Next token is", yyla);
 
+    if (yyla.kind () == symbol_kind::S_YYerror)
+    {
+      // The scanner already issued an error message, process directly
+      // to error recovery.  But do not keep the error token as
+      // lookahead, it is too special and may lead us to an endless
+      // loop in error recovery. */
+      yyla.kind_ = symbol_kind::S_YYUNDEF;
+      goto yyerrlab1;
+    }
+
     /* If the proper action on seeing token YYLA.TYPE is to reduce or
        to detect an error, take that action.  */
-    yyn += yyla.type_get ();
-    if (yyn < 0 || yylast_ < yyn || yycheck_[yyn] != yyla.type_get ())
-      goto yydefault;
+    yyn += yyla.kind ();
+    if (yyn < 0 || yylast_ < yyn || yycheck_[yyn] != yyla.kind ())
+      {
+        goto yydefault;
+      }
 
     // Reduce or error.
     yyn = yytable_[yyn];
@@ -476,20 +509,22 @@ namespace yy {
       --yyerrstatus_;
 
     // Shift the lookahead token.
-    yypush_ ("Shifting", yyn, YY_MOVE (yyla));
+    yypush_ ("Shifting", state_type (yyn), YY_MOVE (yyla));
     goto yynewstate;
 
+
   /*-----------------------------------------------------------.
   | yydefault -- do the default action for the current state.  |
   `-----------------------------------------------------------*/
   yydefault:
-    yyn = yydefact_[yystack_[0].state];
+    yyn = yydefact_[+yystack_[0].state];
     if (yyn == 0)
       goto yyerrlab;
     goto yyreduce;
 
+
   /*-----------------------------.
-  | yyreduce -- Do a reduction.  |
+  | yyreduce -- do a reduction.  |
   `-----------------------------*/
   yyreduce:
     yylen = yyr2_[yyn];
@@ -501,17 +536,14 @@ namespace yy {
          when using variants.  */
       switch (yyr1_[yyn])
     {
-      case 17: // exp
-      case 18: // t
-      case 19: // p
-      case 20: // f
+      case symbol_kind::S_BIGNUM: // "bignum"
+      case symbol_kind::S_exp: // exp
+      case symbol_kind::S_t: // t
+      case symbol_kind::S_p: // p
+      case symbol_kind::S_f: // f
         yylhs.value.emplace< node_t > ();
         break;
 
-      case 14: // "bignum"
-        yylhs.value.emplace< std::shared_ptr<num_t> > ();
-        break;
-
       default:
         break;
     }
@@ -519,8 +551,8 @@ namespace yy {
 
       // Default location.
       {
-        slice<stack_symbol_type, stack_type> slice (yystack_, yylen);
-        YYLLOC_DEFAULT (yylhs.location, slice, yylen);
+        stack_type::slice range (yystack_, yylen);
+        YYLLOC_DEFAULT (yylhs.location, range, yylen);
         yyerror_range[1].location = yylhs.location;
       }
 
@@ -532,96 +564,97 @@ namespace yy {
         {
           switch (yyn)
             {
-  case 2:
-#line 83 "src/parse-bistro.yy" // lalr1.cc:906
-    { p.set_ast(yystack_[0].value.as< node_t > ()); }
-#line 539 "src/parse-bistro.cc" // lalr1.cc:906
+  case 6: // line: exp
+#line 102 "src/parse-bistro.yy"
+  { p.add_ast(yystack_[0].value.as < node_t > ()); }
+#line 571 "src/parse-bistro.cc"
     break;
 
-  case 3:
-#line 88 "src/parse-bistro.yy" // lalr1.cc:906
-    { yylhs.value.as< node_t > () = yystack_[0].value.as< node_t > (); }
-#line 545 "src/parse-bistro.cc" // lalr1.cc:906
+  case 7: // exp: t
+#line 107 "src/parse-bistro.yy"
+  { yylhs.value.as < node_t > () = yystack_[0].value.as < node_t > (); }
+#line 577 "src/parse-bistro.cc"
     break;
 
-  case 4:
-#line 90 "src/parse-bistro.yy" // lalr1.cc:906
-    { yylhs.value.as< node_t > () = p.get_factory()(yystack_[2].value.as< node_t > (), yystack_[0].value.as< node_t > (), bistro::OpType::PLUS); }
-#line 551 "src/parse-bistro.cc" // lalr1.cc:906
+  case 8: // exp: exp "+" t
+#line 109 "src/parse-bistro.yy"
+  { yylhs.value.as < node_t > () = p.make_binop(yystack_[2].value.as < node_t > (), yystack_[0].value.as < node_t > (), bistro::OpType::PLUS); }
+#line 583 "src/parse-bistro.cc"
     break;
 
-  case 5:
-#line 92 "src/parse-bistro.yy" // lalr1.cc:906
-    { yylhs.value.as< node_t > () = p.get_factory()(yystack_[2].value.as< node_t > (), yystack_[0].value.as< node_t > (), bistro::OpType::MINUS); }
-#line 557 "src/parse-bistro.cc" // lalr1.cc:906
+  case 9: // exp: exp "-" t
+#line 111 "src/parse-bistro.yy"
+  { yylhs.value.as < node_t > () = p.make_binop(yystack_[2].value.as < node_t > (), yystack_[0].value.as < node_t > (), bistro::OpType::MINUS); }
+#line 589 "src/parse-bistro.cc"
     break;
 
-  case 6:
-#line 97 "src/parse-bistro.yy" // lalr1.cc:906
-    { yylhs.value.as< node_t > () = yystack_[0].value.as< node_t > (); }
-#line 563 "src/parse-bistro.cc" // lalr1.cc:906
+  case 10: // t: p
+#line 116 "src/parse-bistro.yy"
+  { yylhs.value.as < node_t > () = yystack_[0].value.as < node_t > (); }
+#line 595 "src/parse-bistro.cc"
     break;
 
-  case 7:
-#line 99 "src/parse-bistro.yy" // lalr1.cc:906
-    { yylhs.value.as< node_t > () = p.get_factory()(yystack_[2].value.as< node_t > (), yystack_[0].value.as< node_t > (), bistro::OpType::TIMES); }
-#line 569 "src/parse-bistro.cc" // lalr1.cc:906
+  case 11: // t: t "*" p
+#line 118 "src/parse-bistro.yy"
+  { yylhs.value.as < node_t > () = p.make_binop(yystack_[2].value.as < node_t > (), yystack_[0].value.as < node_t > (), bistro::OpType::TIMES); }
+#line 601 "src/parse-bistro.cc"
     break;
 
-  case 8:
-#line 101 "src/parse-bistro.yy" // lalr1.cc:906
-    { yylhs.value.as< node_t > () = p.get_factory()(yystack_[2].value.as< node_t > (), yystack_[0].value.as< node_t > (), bistro::OpType::DIVIDE); }
-#line 575 "src/parse-bistro.cc" // lalr1.cc:906
+  case 12: // t: t "/" p
+#line 120 "src/parse-bistro.yy"
+  { yylhs.value.as < node_t > () = p.make_binop(yystack_[2].value.as < node_t > (), yystack_[0].value.as < node_t > (), bistro::OpType::DIVIDE); }
+#line 607 "src/parse-bistro.cc"
     break;
 
-  case 9:
-#line 103 "src/parse-bistro.yy" // lalr1.cc:906
-    { yylhs.value.as< node_t > () = p.get_factory()(yystack_[2].value.as< node_t > (), yystack_[0].value.as< node_t > (), bistro::OpType::MODULO); }
-#line 581 "src/parse-bistro.cc" // lalr1.cc:906
+  case 13: // t: t "%" p
+#line 122 "src/parse-bistro.yy"
+  { yylhs.value.as < node_t > () = p.make_binop(yystack_[2].value.as < node_t > (), yystack_[0].value.as < node_t > (), bistro::OpType::MODULO); }
+#line 613 "src/parse-bistro.cc"
     break;
 
-  case 10:
-#line 108 "src/parse-bistro.yy" // lalr1.cc:906
-    { yylhs.value.as< node_t > () = yystack_[0].value.as< node_t > (); }
-#line 587 "src/parse-bistro.cc" // lalr1.cc:906
+  case 14: // p: f
+#line 127 "src/parse-bistro.yy"
+  { yylhs.value.as < node_t > () = yystack_[0].value.as < node_t > (); }
+#line 619 "src/parse-bistro.cc"
     break;
 
-  case 11:
-#line 110 "src/parse-bistro.yy" // lalr1.cc:906
-    { yylhs.value.as< node_t > () = p.get_factory()(yystack_[2].value.as< node_t > (), yystack_[0].value.as< node_t > (), bistro::OpType::POWER); }
-#line 593 "src/parse-bistro.cc" // lalr1.cc:906
+  case 15: // p: p "**" f
+#line 129 "src/parse-bistro.yy"
+  { yylhs.value.as < node_t > () = p.make_binop(yystack_[2].value.as < node_t > (), yystack_[0].value.as < node_t > (), bistro::OpType::POWER); }
+#line 625 "src/parse-bistro.cc"
     break;
 
-  case 12:
-#line 115 "src/parse-bistro.yy" // lalr1.cc:906
-    { yylhs.value.as< node_t > () = p.get_factory()(yystack_[0].value.as< std::shared_ptr<num_t> > ()); }
-#line 599 "src/parse-bistro.cc" // lalr1.cc:906
+  case 16: // f: "bignum"
+#line 134 "src/parse-bistro.yy"
+  { yylhs.value.as < node_t > () = yystack_[0].value.as < node_t > (); }
+#line 631 "src/parse-bistro.cc"
     break;
 
-  case 13:
-#line 117 "src/parse-bistro.yy" // lalr1.cc:906
-    { yylhs.value.as< node_t > () = yystack_[1].value.as< node_t > (); }
-#line 605 "src/parse-bistro.cc" // lalr1.cc:906
+  case 17: // f: "(" exp ")"
+#line 136 "src/parse-bistro.yy"
+  { yylhs.value.as < node_t > () = yystack_[1].value.as < node_t > (); }
+#line 637 "src/parse-bistro.cc"
     break;
 
-  case 14:
-#line 119 "src/parse-bistro.yy" // lalr1.cc:906
-    {
-    yylhs.value.as< node_t > () = p.get_factory()(yystack_[0].value.as< node_t > (), bistro::OpType::MINUS);
+  case 18: // f: "-" f
+#line 138 "src/parse-bistro.yy"
+  {
+    yylhs.value.as < node_t > () = p.make_unop(yystack_[0].value.as < node_t > (), bistro::OpType::MINUS);
   }
-#line 613 "src/parse-bistro.cc" // lalr1.cc:906
+#line 645 "src/parse-bistro.cc"
     break;
 
-  case 15:
-#line 123 "src/parse-bistro.yy" // lalr1.cc:906
-    {
-    yylhs.value.as< node_t > () = p.get_factory()(yystack_[0].value.as< node_t > (), bistro::OpType::PLUS);
+  case 19: // f: "+" f
+#line 142 "src/parse-bistro.yy"
+  {
+    yylhs.value.as < node_t > () = p.make_unop(yystack_[0].value.as < node_t > (), bistro::OpType::PLUS);
   }
-#line 621 "src/parse-bistro.cc" // lalr1.cc:906
+#line 653 "src/parse-bistro.cc"
     break;
 
 
-#line 625 "src/parse-bistro.cc" // lalr1.cc:906
+#line 657 "src/parse-bistro.cc"
+
             default:
               break;
             }
@@ -629,6 +662,7 @@ namespace yy {
 #if YY_EXCEPTIONS
       catch (const syntax_error& yyexc)
         {
+          YYCDEBUG << "Caught exception: " << yyexc.what() << '\n';
           error (yyexc);
           YYERROR;
         }
@@ -636,13 +670,13 @@ namespace yy {
       YY_SYMBOL_PRINT ("-> $$ =", yylhs);
       yypop_ (yylen);
       yylen = 0;
-      YY_STACK_PRINT ();
 
       // Shift the result of the reduction.
       yypush_ (YY_NULLPTR, YY_MOVE (yylhs));
     }
     goto yynewstate;
 
+
   /*--------------------------------------.
   | yyerrlab -- here on detecting error.  |
   `--------------------------------------*/
@@ -651,7 +685,8 @@ namespace yy {
     if (!yyerrstatus_)
       {
         ++yynerrs_;
-        error (yyla.location, yysyntax_error_ (yystack_[0].state, yyla));
+        std::string msg = YY_("syntax error");
+        error (yyla.location, YY_MOVE (msg));
       }
 
 
@@ -662,7 +697,7 @@ namespace yy {
            error, discard it.  */
 
         // Return failure if at end of input.
-        if (yyla.type_get () == yyeof_)
+        if (yyla.kind () == symbol_kind::S_YYEOF)
           YYABORT;
         else if (!yyla.empty ())
           {
@@ -679,68 +714,81 @@ namespace yy {
   | yyerrorlab -- error raised explicitly by YYERROR.  |
   `---------------------------------------------------*/
   yyerrorlab:
-
-    /* Pacify compilers like GCC when the user code never invokes
-       YYERROR and the label yyerrorlab therefore never appears in user
-       code.  */
+    /* Pacify compilers when the user code never invokes YYERROR and
+       the label yyerrorlab therefore never appears in user code.  */
     if (false)
-      goto yyerrorlab;
+      YYERROR;
+
     /* Do not reclaim the symbols of the rule whose action triggered
        this YYERROR.  */
     yypop_ (yylen);
     yylen = 0;
+    YY_STACK_PRINT ();
     goto yyerrlab1;
 
+
   /*-------------------------------------------------------------.
   | yyerrlab1 -- common code for both syntax error and YYERROR.  |
   `-------------------------------------------------------------*/
   yyerrlab1:
     yyerrstatus_ = 3;   // Each real token shifted decrements this.
-    {
-      stack_symbol_type error_token;
-      for (;;)
-        {
-          yyn = yypact_[yystack_[0].state];
-          if (!yy_pact_value_is_default_ (yyn))
-            {
-              yyn += yyterror_;
-              if (0 <= yyn && yyn <= yylast_ && yycheck_[yyn] == yyterror_)
-                {
-                  yyn = yytable_[yyn];
-                  if (0 < yyn)
-                    break;
-                }
-            }
+    // Pop stack until we find a state that shifts the error token.
+    for (;;)
+      {
+        yyn = yypact_[+yystack_[0].state];
+        if (!yy_pact_value_is_default_ (yyn))
+          {
+            yyn += symbol_kind::S_YYerror;
+            if (0 <= yyn && yyn <= yylast_
+                && yycheck_[yyn] == symbol_kind::S_YYerror)
+              {
+                yyn = yytable_[yyn];
+                if (0 < yyn)
+                  break;
+              }
+          }
 
-          // Pop the current state because it cannot handle the error token.
-          if (yystack_.size () == 1)
-            YYABORT;
+        // Pop the current state because it cannot handle the error token.
+        if (yystack_.size () == 1)
+          YYABORT;
 
-          yyerror_range[1].location = yystack_[0].location;
-          yy_destroy_ ("Error: popping", yystack_[0]);
-          yypop_ ();
-          YY_STACK_PRINT ();
-        }
+        yyerror_range[1].location = yystack_[0].location;
+        yy_destroy_ ("Error: popping", yystack_[0]);
+        yypop_ ();
+        YY_STACK_PRINT ();
+      }
+    {
+      stack_symbol_type error_token;
 
       yyerror_range[2].location = yyla.location;
       YYLLOC_DEFAULT (error_token.location, yyerror_range, 2);
 
       // Shift the error token.
-      error_token.state = yyn;
+      error_token.state = state_type (yyn);
       yypush_ ("Shifting", YY_MOVE (error_token));
     }
     goto yynewstate;
 
-    // Accept.
+
+  /*-------------------------------------.
+  | yyacceptlab -- YYACCEPT comes here.  |
+  `-------------------------------------*/
   yyacceptlab:
     yyresult = 0;
     goto yyreturn;
 
-    // Abort.
+
+  /*-----------------------------------.
+  | yyabortlab -- YYABORT comes here.  |
+  `-----------------------------------*/
   yyabortlab:
     yyresult = 1;
     goto yyreturn;
 
+
+  /*-----------------------------------------------------.
+  | yyreturn -- parsing is finished, return the result.  |
+  `-----------------------------------------------------*/
   yyreturn:
     if (!yyla.empty ())
       yy_destroy_ ("Cleanup: discarding lookahead", yyla);
@@ -748,6 +796,7 @@ namespace yy {
     /* Do not reclaim the symbols of the rule whose action triggered
        this YYABORT or YYACCEPT.  */
     yypop_ (yylen);
+    YY_STACK_PRINT ();
     while (1 < yystack_.size ())
       {
         yy_destroy_ ("Cleanup: popping", yystack_[0]);
@@ -781,126 +830,134 @@ namespace yy {
     error (yyexc.location, yyexc.what ());
   }
 
-  // Generate an error message.
-  std::string
-  parser::yysyntax_error_ (state_type, const symbol_type&) const
+#if YYDEBUG || 0
+  const char *
+  parser::symbol_name (symbol_kind_type yysymbol)
   {
-    return YY_("syntax error");
+    return yytname_[yysymbol];
   }
+#endif // #if YYDEBUG || 0
+
 
 
-  const signed char parser::yypact_ninf_ = -8;
+
+
+
+
+
+
+  const signed char parser::yypact_ninf_ = -11;
 
   const signed char parser::yytable_ninf_ = -1;
 
   const signed char
   parser::yypact_[] =
   {
-       3,    10,    15,    11,    -8,    13,    -2,    -2,    -2,    -2,
-      -8,     9,     1,    16,    -8,    -8,    -8,     0,    -2,    -2,
-      -2,    -2,    -2,    -2,    -8,     1,     1,    16,    16,    16,
-      -8
+       3,     6,    22,    10,   -11,    13,    -2,    -2,    -2,    -2,
+     -11,    14,   -11,    12,     1,    17,   -11,   -11,   -11,     0,
+      -2,    -2,    -2,    -2,    -2,    -2,    -2,   -11,   -11,     1,
+       1,    17,    17,    17,   -11
   };
 
-  const unsigned char
+  const signed char
   parser::yydefact_[] =
   {
-       0,     0,     0,     0,     1,     0,     0,     0,     0,     0,
-      12,     2,     3,     6,    10,    15,    14,     0,     0,     0,
-       0,     0,     0,     0,    13,     4,     5,     7,     8,     9,
-      11
+       0,     0,     0,     0,     1,     0,     5,     0,     0,     0,
+      16,     2,     3,     6,     7,    10,    14,    19,    18,     0,
+       5,     0,     0,     0,     0,     0,     0,    17,     4,     8,
+       9,    11,    12,    13,    15
   };
 
   const signed char
   parser::yypgoto_[] =
   {
-      -8,    -8,    17,     2,    -3,    -7
+     -11,   -11,   -11,     7,    19,    -1,   -10,    -7
   };
 
   const signed char
   parser::yydefgoto_[] =
   {
-      -1,     2,    11,    12,    13,    14
+       0,     2,    11,    12,    13,    14,    15,    16
   };
 
-  const unsigned char
+  const signed char
   parser::yytable_[] =
   {
-      15,    16,     7,     8,    18,    19,     1,    20,     9,    21,
-      22,    24,    10,    18,    19,     4,    30,    27,    28,    29,
-      25,    26,     3,    23,     5,     6,    17
+      17,    18,     7,     8,    21,    22,     1,    23,     9,    24,
+      25,    27,    10,    31,    32,    33,    21,    22,     3,    34,
+      29,    30,     4,     5,    26,     6,    20,    28,    19
   };
 
-  const unsigned char
+  const signed char
   parser::yycheck_[] =
   {
        7,     8,     4,     5,     4,     5,     3,     6,    10,     8,
-       9,    11,    14,     4,     5,     0,    23,    20,    21,    22,
-      18,    19,    12,     7,    13,    12,     9
+       9,    11,    14,    23,    24,    25,     4,     5,    12,    26,
+      21,    22,     0,    13,     7,    12,    12,    20,     9
   };
 
-  const unsigned char
+  const signed char
   parser::yystos_[] =
   {
        0,     3,    16,    12,     0,    13,    12,     4,     5,    10,
-      14,    17,    18,    19,    20,    20,    20,    17,     4,     5,
-       6,     8,     9,     7,    11,    18,    18,    19,    19,    19,
-      20
+      14,    17,    18,    19,    20,    21,    22,    22,    22,    19,
+      12,     4,     5,     6,     8,     9,     7,    11,    18,    20,
+      20,    21,    21,    21,    22
   };
 
-  const unsigned char
+  const signed char
   parser::yyr1_[] =
   {
-       0,    15,    16,    17,    17,    17,    18,    18,    18,    18,
-      19,    19,    20,    20,    20,    20
+       0,    15,    16,    17,    17,    18,    18,    19,    19,    19,
+      20,    20,    20,    20,    21,    21,    22,    22,    22,    22
   };
 
-  const unsigned char
+  const signed char
   parser::yyr2_[] =
   {
-       0,     2,     5,     1,     3,     3,     1,     3,     3,     3,
-       1,     3,     1,     3,     2,     2
+       0,     2,     5,     1,     3,     0,     1,     1,     3,     3,
+       1,     3,     3,     3,     1,     3,     1,     3,     2,     2
   };
 
 
 #if YYDEBUG
   // YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
-  // First, the terminals, then, starting at \a yyntokens_, nonterminals.
+  // First, the terminals, then, starting at \a YYNTOKENS, nonterminals.
   const char*
   const parser::yytname_[] =
   {
-  "\"end-of-mine\"", "error", "$undefined", "\"base-length\"", "\"+\"",
-  "\"-\"", "\"*\"", "\"**\"", "\"/\"", "\"%\"", "\"(\"", "\")\"",
-  "\"\\n\"", "\"base\"", "\"bignum\"", "$accept", "program", "exp", "t",
-  "p", "f", YY_NULLPTR
+  "\"end-of-mine\"", "error", "\"invalid token\"", "\"base-length\"",
+  "\"+\"", "\"-\"", "\"*\"", "\"**\"", "\"/\"", "\"%\"", "\"(\"", "\")\"",
+  "\"\\n\"", "\"base\"", "\"bignum\"", "$accept", "program", "lines",
+  "line", "exp", "t", "p", "f", YY_NULLPTR
   };
+#endif
 
 
+#if YYDEBUG
   const unsigned char
   parser::yyrline_[] =
   {
-       0,    82,    82,    87,    89,    91,    96,    98,   100,   102,
-     107,   109,   114,   116,   118,   122
+       0,    91,    91,    95,    96,   100,   101,   106,   108,   110,
+     115,   117,   119,   121,   126,   128,   133,   135,   137,   141
   };
 
-  // Print the state stack on the debug stream.
   void
-  parser::yystack_print_ ()
+  parser::yy_stack_print_ () const
   {
     *yycdebug_ << "Stack now";
     for (stack_type::const_iterator
            i = yystack_.begin (),
            i_end = yystack_.end ();
          i != i_end; ++i)
-      *yycdebug_ << ' ' << i->state;
+      *yycdebug_ << ' ' << int (i->state);
     *yycdebug_ << '\n';
   }
 
-  // Report on the debug stream that the rule \a yyrule is going to be reduced.
   void
-  parser::yy_reduce_print_ (int yyrule)
+  parser::yy_reduce_print_ (int yyrule) const
   {
-    unsigned yylno = yyrline_[yyrule];
+    int yylno = yyrline_[yyrule];
     int yynrhs = yyr2_[yyrule];
     // Print the symbols being reduced, and their result.
     *yycdebug_ << "Reducing stack by rule " << yyrule - 1
@@ -913,10 +970,10 @@ namespace yy {
 #endif // YYDEBUG
 
 
-
 } // yy
-#line 919 "src/parse-bistro.cc" // lalr1.cc:1217
-#line 128 "src/parse-bistro.yy" // lalr1.cc:1218
+#line 975 "src/parse-bistro.cc"
+
+#line 147 "src/parse-bistro.yy"
 
 void yy::parser::error(const location_type& l, const std::string& m)
 {
@@ -7,7 +7,7 @@
 %skeleton "lalr1.cc"
 %expect 0
 %defines
-%param {bistro::parser::ParseDriver& p}
+%param {bistro::parser::ParseDriver& p} {void* yyscanner}
 
 %token            BASE_LEN  "base-length"
                   PLUS      "+"
@@ -21,7 +21,7 @@
                   NEWLINE   "\n"
                   BASE      "base"
                   EOF 0     "end-of-mine"
-%token <std::shared_ptr<num_t>> BIGNUM    "bignum"
+%token <node_t>   BIGNUM    "bignum"
 %type <node_t> exp t f p
 
 %code requires
@@ -31,23 +31,32 @@
 #include "bignum.hh"
 #include "parse-driver.hh"
 #include "ast-node.hh"
-using num_t = bistro::parser::ParseDriver::num_t;
-using base_t = bistro::parser::ParseDriver::base_t;
-using node_t = std::shared_ptr<bistro::ASTNode<num_t, base_t>>;
+using node_t = bistro::parser::ParseDriver::node_t;
 }
 
 %code provides
 {
 #define YY_DECL                                           \
-  yy::parser::symbol_type yylex(bistro::parser::ParseDriver& p)
+  yy::parser::symbol_type yylex(bistro::parser::ParseDriver& p, \
+                                void* yyscanner)
 
 YY_DECL;
-extern FILE* yyin;
 }
 
 %start program
 
 /*
+ * A program is the base header followed by one expression per line. Each
+ * expression is independent; empty lines are ignored.
+ *
+ *   Program := base-length '\n' base '\n' Lines
+ *
+ *   Lines := Line
+ *          | Lines '\n' Line
+ *
+ *   Line := <empty>
+ *         | Exp
+ *
  * The operators handled are:
  *   - '+', '-' (both unary and binary)
  *   - '*', '/', '%' with a higher priority
@@ -72,56 +81,66 @@ extern FILE* yyin;
  *      | '-' F
  *      | '+' F
  *
- * This grammar is left-associative. AST Nodes are constructred using the
- * ASTFactory.
+ * This grammar is left-associative. AST Nodes are constructred through the
+ * driver, by the ASTFactory of the type of digits it picked.
  */
 
 %%
 
 program:
-  BASE_LEN NEWLINE BASE NEWLINE exp
-  { p.set_ast($5); }
+  BASE_LEN NEWLINE BASE NEWLINE lines
+;
+
+lines:
+  line
+| lines NEWLINE line
+;
+
+line:
+  %empty
+| exp
+  { p.add_ast($1); }
 ;
 
 exp:
   t
   { $$ = $1; }
 | exp PLUS t
-  { $$ = p.get_factory()($1, $3, bistro::OpType::PLUS); }
+  { $$ = p.make_binop($1, $3, bistro::OpType::PLUS); }
 | exp MINUS t
-  { $$ = p.get_factory()($1, $3, bistro::OpType::MINUS); }
+  { $$ = p.make_binop($1, $3, bistro::OpType::MINUS); }
 ;
 
 t:
   p
   { $$ = $1; }
 | t MUL p
-  { $$ = p.get_factory()($1, $3, bistro::OpType::TIMES); }
+  { $$ = p.make_binop($1, $3, bistro::OpType::TIMES); }
 | t DIV p
-  { $$ = p.get_factory()($1, $3, bistro::OpType::DIVIDE); }
+  { $$ = p.make_binop($1, $3, bistro::OpType::DIVIDE); }
 | t MOD p
-  { $$ = p.get_factory()($1, $3, bistro::OpType::MODULO); }
+  { $$ = p.make_binop($1, $3, bistro::OpType::MODULO); }
 ;
 
 p:
   f
   { $$ = $1; }
 | p POW f
-  { $$ = p.get_factory()($1, $3, bistro::OpType::POWER); }
+  { $$ = p.make_binop($1, $3, bistro::OpType::POWER); }
 ;
 
 f:
   BIGNUM
-  { $$ = p.get_factory()($1); }
+  { $$ = $1; }
 | LPAR exp RPAR
   { $$ = $2; }
 | MINUS f
   {
-    $$ = p.get_factory()($2, bistro::OpType::MINUS);
+    $$ = p.make_unop($2, bistro::OpType::MINUS);
   }
 | PLUS f
   {
-    $$ = p.get_factory()($2, bistro::OpType::PLUS);
+    $$ = p.make_unop($2, bistro::OpType::PLUS);
   }
 ;
 
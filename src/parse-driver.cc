@@ -1,46 +1,162 @@
 #include "parse-driver.hh"
 #include "parse-bistro.hh"
+#include "mapped-file.hh"
+#include "pratt-parser.hh"
+
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sys/stat.h>
 
 namespace bistro
 {
   namespace parser
   {
-    std::shared_ptr<ASTNode<num_t, base_t>> ParseDriver::parse()
+    ParseDriver::node_t ParseDriver::parse()
     {
-      yyin = fopen(filename_.c_str(), "r");
-      if (!yyin)
+      // Pipes and other special files have no size to map: they are read
+      // into a buffer instead.
+      struct stat st;
+      if (stat(filename_.c_str(), &st) < 0 || S_ISREG(st.st_mode))
+      {
+        MappedFile file(filename_, 2);
+        return parse_buffer(file.data(), file.size());
+      }
+      std::ifstream in(filename_, std::ios::binary);
+      if (!in)
         throw std::runtime_error("Could not open file.");
-      yy::parser p(*this);
-      p.parse();
-      fclose(yyin);
+      std::string buffer{std::istreambuf_iterator<char>(in),
+                         std::istreambuf_iterator<char>()};
+      if (in.bad())
+        throw std::runtime_error("Could not read file.");
+      size_t size = buffer.size();
+      buffer.append(2, '\0');
+      return parse_buffer(buffer.data(), size);
+    }
+
+    ParseDriver::node_t ParseDriver::parse_string(std::string_view input)
+    {
+      std::string buffer;
+      buffer.reserve(input.size() + 2);
+      buffer.append(input).append(2, '\0');
+      return parse_buffer(buffer.data(), input.size());
+    }
+
+    ParseDriver::node_t ParseDriver::parse_buffer(char* data, size_t size)
+    {
+      if (parser_ == ParserType::PRATT)
+      {
+        reset();
+        PrattParser(*this, data, size).parse();
+        if (error_)
+          throw std::runtime_error("Parsing failed.");
+        return get_ast();
+      }
+
+      // flex scans in place a buffer ending with two NUL bytes.
+      scan_begin(data, size + 2);
+      yy::parser p(*this, scanner_);
+      try
+      {
+        p.parse();
+      }
+      catch (...)
+      {
+        scan_end();
+        throw;
+      }
+      scan_end();
       if (error_)
         throw std::runtime_error("Parsing failed.");
-      return ast_;
+      return get_ast();
+    }
+
+    ParseDriver::node_t ParseDriver::parse_lines(std::string_view input)
+    {
+      loc_ = yy::location();
+      std::visit([](auto& prog) { prog.asts.clear(); }, program_);
+      error_ = false;
+      PrattParser(*this, input.data(), input.size()).parse_lines();
+      if (error_)
+        throw std::runtime_error("Parsing failed.");
+      return get_ast();
+    }
+
+    void ParseDriver::reset()
+    {
+      loc_ = yy::location();
+      base_length_ = 0;
+      program_ = program_t();
+      new_factory_(program_);
+      error_ = false;
+    }
+
+    void ParseDriver::add_ast(const node_t& ast)
+    {
+      std::visit([&ast](auto& prog)
+      {
+        using prog_t = std::decay_t<decltype(prog)>;
+        prog.asts.push_back(std::get<typename prog_t::node_t>(ast));
+      }, program_);
+    }
+
+    ParseDriver::node_t ParseDriver::get_ast() const
+    {
+      return std::visit([](const auto& prog) -> node_t
+      {
+        using prog_t = std::decay_t<decltype(prog)>;
+        if (prog.asts.empty())
+          return typename prog_t::node_t();
+        return prog.asts.front();
+      }, program_);
     }
 
-    void ParseDriver::set_ast(std::shared_ptr<ASTNode<num_t, base_t>>& ast)
+    ParseDriver::node_t
+    ParseDriver::make_number(std::string_view digits) const
     {
-      ast_ = ast;
+      return std::visit([digits](const auto& prog) -> node_t
+      {
+        using prog_t = std::decay_t<decltype(prog)>;
+        return (*prog.fact)(
+          std::make_shared<typename prog_t::num_t>(digits, prog.base));
+      }, program_);
     }
 
-    std::shared_ptr<ASTNode<num_t, base_t>> ParseDriver::get_ast() const
+    ParseDriver::node_t ParseDriver::make_unop(const node_t& operand,
+                                               OpType op) const
     {
-      return ast_;
+      return std::visit([&operand, op](const auto& prog) -> node_t
+      {
+        using prog_t = std::decay_t<decltype(prog)>;
+        using node_type = typename prog_t::node_t;
+        return (*prog.fact)(std::get<node_type>(operand), op);
+      }, program_);
     }
 
-    void ParseDriver::set_base(base_t& base)
+    ParseDriver::node_t ParseDriver::make_binop(const node_t& lhs,
+                                                const node_t& rhs,
+                                                OpType op) const
     {
-      base_ = base;
+      return std::visit([&lhs, &rhs, op](const auto& prog) -> node_t
+      {
+        using prog_t = std::decay_t<decltype(prog)>;
+        using node_type = typename prog_t::node_t;
+        return (*prog.fact)(std::get<node_type>(lhs),
+                            std::get<node_type>(rhs), op);
+      }, program_);
     }
 
-    base_t& ParseDriver::get_base()
+    void ParseDriver::add_digit(char repr)
     {
-      return base_;
+      std::visit([repr](auto& prog) { prog.base.add_digit(repr); }, program_);
     }
 
-    const base_t& ParseDriver::get_base() const
+    size_t ParseDriver::get_base_num() const
     {
-      return base_;
+      return std::visit([](const auto& prog)
+      {
+        return prog.base.get_base_num();
+      }, program_);
     }
 
     bool ParseDriver::get_error() const
@@ -58,9 +174,64 @@ namespace bistro
       return filename_;
     }
 
-    const ASTFactory<num_t, base_t>& ParseDriver::get_factory() const
+    yy::location& ParseDriver::get_location()
+    {
+      return loc_;
+    }
+
+    size_t ParseDriver::get_base_length() const
+    {
+      return base_length_;
+    }
+
+    void ParseDriver::set_base_length(size_t length)
+    {
+      base_length_ = length;
+      switch (length)
+      {
+      case 2:
+        program_.emplace<Program<uint8_t, 2>>();
+        break;
+      case 4:
+        program_.emplace<Program<uint8_t, 4>>();
+        break;
+      case 8:
+        program_.emplace<Program<uint8_t, 8>>();
+        break;
+      case 10:
+        program_.emplace<Program<uint8_t, 10>>();
+        break;
+      case 16:
+        program_.emplace<Program<uint8_t, 16>>();
+        break;
+      case 32:
+        program_.emplace<Program<uint8_t, 32>>();
+        break;
+      case 64:
+        program_.emplace<Program<uint8_t, 64>>();
+        break;
+      case 128:
+        program_.emplace<Program<uint8_t, 128>>();
+        break;
+      default:
+        // The greatest value of a type marks a representation without a
+        // digit in Base: the digits of the base are below it. A base is
+        // made of distinct characters, so a longer one cannot be read.
+        if (length > std::numeric_limits<uint8_t>::max())
+          throw std::out_of_range("invalid base length");
+        program_.emplace<Program<uint8_t>>();
+      }
+      new_factory_(program_);
+    }
+
+    ParseDriver::ParserType ParseDriver::get_parser() const
+    {
+      return parser_;
+    }
+
+    void ParseDriver::set_parser(ParserType parser)
     {
-      return fact_;
+      parser_ = parser;
     }
   }
 }
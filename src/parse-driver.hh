@@ -1,47 +1,209 @@
 #pragma once
 
+#include <cstddef> // size_t
 #include <memory>
 #include <string>
+#include <string_view>
 #include <stdexcept>
+#include <type_traits> // decay_t
+#include <utility> // forward
+#include <variant>
+#include <vector>
 
 #include "ast-node.hh"
 #include "ast-factory.hh"
 #include "base.hh"
 #include "bignum.hh"
+#include "location.hh"
 
 namespace bistro
 {
   namespace parser
   {
+    /**
+    ** Program parsed with the digits stored as \a Value, in the radix
+    ** \a Radix if nonzero (see BigNum): its base, its ASTs in input order,
+    ** and the factory building them.
+    **/
+    template <typename Value, std::size_t Radix = 0>
+    struct Program
+    {
+      using value_t = Value;
+      using base_t = Base<value_t>;
+      using num_t = BigNum<value_t, Radix>;
+      using ast_t = ASTNode<num_t, base_t>;
+      using node_t = std::shared_ptr<ast_t>;
+      using factory_t = ASTFactory<num_t, base_t>;
+
+      base_t base;
+      std::vector<node_t> asts;
+      std::shared_ptr<const factory_t> fact;
+    };
+
+    /// Variants of the programs \a Programs, and of their nodes.
+    template <typename... Programs>
+    struct ProgramSet
+    {
+      using program_t = std::variant<Programs...>;
+      using node_t = std::variant<typename Programs::node_t...>;
+      /// Variant of the F<num_t, base_t> of the programs.
+      template <template <typename, typename> class F>
+      using apply_t = std::variant<F<typename Programs::num_t,
+                                     typename Programs::base_t>...>;
+    };
+
+    /**
+    ** Parse a file into an AST.
+    **
+    ** The input is either a file, given at construction, or a buffer in
+    ** memory. The scanner state lives in the driver, so that several drivers
+    ** can run concurrently.
+    **
+    ** A program holds one expression per line. The parse functions return
+    ** the first one; visit gives all of them, in input order.
+    **
+    ** The input is parsed either by the bison parser, on the tokens of the
+    ** flex scanner, or by the hand-written PrattParser, see set_parser.
+    **
+    ** The type of the numbers is picked once the base length is read, see
+    ** set_base_length: base 10 and the powers of two up to 128 have their
+    ** radix fixed at compile time, the others a runtime one. A base is made
+    ** of distinct characters, so its digits always fit a uint8_t. The
+    ** parsers build the nodes through the driver, whatever the type picked,
+    ** and the program parsed, a Program<value_t, Radix>, is handed to visit.
+    **/
     class ParseDriver
     {
     public:
-      using value_t = uint32_t;
-      using base_t = Base<value_t>;
-      using num_t = BigNum<value_t>;
+      /// Parser run by the parse functions.
+      enum class ParserType
+      {
+        BISON,
+        PRATT,
+      };
+
+      /// Programs with a runtime radix, then with a static one.
+      using programs_t = ProgramSet<Program<uint8_t>, Program<uint8_t, 10>,
+                                    Program<uint8_t, 2>, Program<uint8_t, 4>,
+                                    Program<uint8_t, 8>, Program<uint8_t, 16>,
+                                    Program<uint8_t, 32>,
+                                    Program<uint8_t, 64>,
+                                    Program<uint8_t, 128>>;
+      /// Program parsed, with one of the number types.
+      using program_t = programs_t::program_t;
+      /// Node of the program parsed.
+      using node_t = programs_t::node_t;
+
+      /// Driver for in-memory inputs, see parse_string and parse_buffer.
+      ParseDriver() = default;
 
       ParseDriver(const std::string& filename)
         : filename_(filename)
       {}
 
-      std::shared_ptr<ASTNode<num_t, base_t>> parse();
-      void set_ast(std::shared_ptr<ASTNode<num_t, base_t>>& ast);
-      std::shared_ptr<ASTNode<num_t, base_t>> get_ast() const;
-      void set_base(base_t& base);
-      base_t& get_base();
-      const base_t& get_base() const;
+      /**
+      ** Parse the file given at construction, mapped in memory if regular,
+      ** read into a buffer otherwise, e.g. for a pipe.
+      **/
+      node_t parse();
+      /// Parse \a input, through a single copy padded for the scanner.
+      node_t parse_string(std::string_view input);
+      /**
+      ** Parse the \a size bytes at \a data in place, without any copy.
+      **
+      ** data[size] and data[size + 1] must be NUL bytes. The buffer may be
+      ** modified while it is scanned.
+      **/
+      node_t parse_buffer(char* data, size_t size);
+      /**
+      ** Parse \a input, lines of expressions without the base header, in
+      ** the base of the previous parsing, with the PrattParser. The ASTs
+      ** parsed before are dropped; the base and the factory are kept.
+      **/
+      node_t parse_lines(std::string_view input);
+      void add_ast(const node_t& ast);
+      /// Get the first AST, a null pointer if none.
+      node_t get_ast() const;
+
+      /**
+      ** Call \a f on the program parsed, a Program<value_t, Radix> for the
+      ** type of numbers picked, and return its result.
+      **/
+      template <typename F>
+      decltype(auto) visit(F&& f) const
+      {
+        return std::visit(std::forward<F>(f), program_);
+      }
+
+      /// Build a node for the number of digits \a digits.
+      /// \throw std::out_of_range if a digit is not in the base.
+      node_t make_number(std::string_view digits) const;
+      /// Build a node for the unary operation \a op on \a operand.
+      node_t make_unop(const node_t& operand, OpType op) const;
+      /// Build a node for the binary operation \a op on \a lhs and \a rhs.
+      node_t make_binop(const node_t& lhs, const node_t& rhs,
+                        OpType op) const;
+
+      /// Add the digit represented by \a repr to the base, see Base.
+      void add_digit(char repr);
+      /// Number of digits of the base read so far.
+      size_t get_base_num() const;
       bool get_error() const;
       void set_error();
-      const ASTFactory<num_t, base_t>& get_factory() const;
+
+      /**
+      ** Build the ASTs with a \a Factory, e.g. a FlatASTFactory, for the
+      ** type of digits picked.
+      **/
+      template <template <typename, typename> class Factory>
+      void set_factory()
+      {
+        new_factory_ = &new_factory<Factory>;
+      }
+
       const std::string& get_filename() const;
+      yy::location& get_location();
+      size_t get_base_length() const;
+      /**
+      ** Set the base length to \a length, and pick the type of numbers.
+      **
+      ** \throw std::out_of_range if \a length is over 255.
+      **/
+      void set_base_length(size_t length);
+      ParserType get_parser() const;
+      void set_parser(ParserType parser);
 
     private:
-      std::shared_ptr<ASTNode<num_t, base_t>> ast_;
-      base_t base_;
+      /// Reset the state of the previous parsing.
+      void reset();
+      /// Start a scanner on the \a size bytes at \a data, in place.
+      void scan_begin(char* data, size_t size);
+      /// Destroy the scanner and its buffer.
+      void scan_end();
+
+      /// Reentrant flex scanner (a yyscan_t).
+      void* scanner_ = nullptr;
+      yy::location loc_;
+      size_t base_length_ = 0;
+
+      program_t program_;
       bool error_ = false;
+      ParserType parser_ = ParserType::BISON;
       const std::string filename_;
-      const ASTFactory<num_t, base_t> fact_;
+      /// Set the factory of a new program.
+      void (*new_factory_)(program_t&) = &new_factory<ASTFactory>;
 
+      /// Set the factory of \a program to a \a Factory.
+      template <template <typename, typename> class Factory>
+      static void new_factory(program_t& program)
+      {
+        std::visit([](auto& prog)
+        {
+          using prog_t = std::decay_t<decltype(prog)>;
+          prog.fact = std::make_shared<
+            Factory<typename prog_t::num_t, typename prog_t::base_t>>();
+        }, program);
+      }
     };
   }
 }
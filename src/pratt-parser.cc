@@ -0,0 +1,279 @@
+#include "pratt-parser.hh"
+#include "digit-run.hh"
+
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+
+namespace bistro
+{
+  namespace parser
+  {
+    PrattParser::PrattParser(ParseDriver& driver, const char* data,
+                             size_t size)
+      : driver_(driver)
+      , pos_(data)
+      , end_(data + size)
+      , line_begin_(data)
+    {}
+
+    void PrattParser::parse()
+    {
+      try
+      {
+        parse_header();
+        lines();
+      }
+      catch (Error&)
+      {
+        driver_.set_error();
+      }
+    }
+
+    void PrattParser::parse_lines()
+    {
+      try
+      {
+        lines();
+      }
+      catch (Error&)
+      {
+        driver_.set_error();
+      }
+    }
+
+    void PrattParser::lines()
+    {
+      next();
+      while (token_ != Token::END)
+      {
+        if (token_ != Token::NEWLINE)
+        {
+          driver_.add_ast(parse_exp(1));
+          if (token_ == Token::END)
+            break;
+          if (token_ != Token::NEWLINE)
+            syntax_error();
+        }
+        next();
+      }
+    }
+
+    void PrattParser::parse_header()
+    {
+      // The base length, in base 10, on its own line.
+      token_begin_ = pos_;
+      size_t length = 0;
+      for (; pos_ != end_ && *pos_ >= '0' && *pos_ <= '9'; ++pos_)
+      {
+        size_t digit = *pos_ - '0';
+        if (length > (std::numeric_limits<size_t>::max() - digit) / 10)
+          error("invalid base length.");
+        length = length * 10 + digit;
+      }
+      if (pos_ != end_ && *pos_ != '\n')
+      {
+        token_begin_ = pos_++;
+        error("invalid character in base length.");
+      }
+      if (pos_ == token_begin_ || pos_ == end_)
+        syntax_error();
+      try
+      {
+        driver_.set_base_length(length);
+      }
+      catch (std::out_of_range&)
+      {
+        error("invalid base length.");
+      }
+      line_++;
+      line_begin_ = ++pos_;
+
+      // The representation of each digit, in order, then a newline.
+      token_begin_ = pos_;
+      if (!length)
+        error("base actual length differ from announced length");
+      while (driver_.get_base_num() != length)
+      {
+        token_begin_ = pos_;
+        if (pos_ == end_)
+          syntax_error();
+        char c = *pos_++;
+        if (c != '\n' && ends_digit_run(c))
+          error("invalid use of reserved character in base.");
+        try
+        {
+          driver_.add_digit(c);
+        }
+        catch (std::invalid_argument& e)
+        {
+          error(e.what());
+        }
+        if (c == '\n')
+        {
+          line_++;
+          line_begin_ = pos_;
+        }
+      }
+      token_begin_ = pos_;
+      if (pos_ == end_)
+        syntax_error();
+      if (*pos_ != '\n')
+        error("base actual length differ from announced length");
+      line_++;
+      line_begin_ = ++pos_;
+    }
+
+    PrattParser::node_t PrattParser::parse_exp(int power)
+    {
+      node_t lhs = parse_operand();
+      for (;;)
+      {
+        int op_power;
+        OpType op;
+        switch (token_)
+        {
+        case Token::PLUS:
+          op_power = 1, op = OpType::PLUS;
+          break;
+        case Token::MINUS:
+          op_power = 1, op = OpType::MINUS;
+          break;
+        case Token::MUL:
+          op_power = 2, op = OpType::TIMES;
+          break;
+        case Token::DIV:
+          op_power = 2, op = OpType::DIVIDE;
+          break;
+        case Token::MOD:
+          op_power = 2, op = OpType::MODULO;
+          break;
+        case Token::POW:
+          op_power = 3, op = OpType::POWER;
+          break;
+        default:
+          return lhs;
+        }
+        if (op_power < power)
+          return lhs;
+        next();
+        // The operators are left-associative: the right operand only holds
+        // operators of a higher priority.
+        node_t rhs = parse_exp(op_power + 1);
+        lhs = driver_.make_binop(lhs, rhs, op);
+      }
+    }
+
+    PrattParser::node_t PrattParser::parse_operand()
+    {
+      switch (token_)
+      {
+      case Token::BIGNUM:
+        {
+          node_t num;
+          try
+          {
+            std::string_view digits(token_begin_, pos_ - token_begin_);
+            num = driver_.make_number(digits);
+          }
+          catch (std::out_of_range& e)
+          {
+            error("invalid digit in number.");
+          }
+          next();
+          return num;
+        }
+      case Token::LPAR:
+        {
+          next();
+          node_t exp = parse_exp(1);
+          expect(Token::RPAR);
+          return exp;
+        }
+      case Token::MINUS:
+      case Token::PLUS:
+        {
+          OpType op = token_ == Token::MINUS ? OpType::MINUS : OpType::PLUS;
+          next();
+          return driver_.make_unop(parse_operand(), op);
+        }
+      default:
+        syntax_error();
+      }
+    }
+
+    void PrattParser::next()
+    {
+      if (token_ == Token::NEWLINE)
+      {
+        line_++;
+        line_begin_ = pos_;
+      }
+      token_begin_ = pos_;
+      if (pos_ == end_)
+      {
+        token_ = Token::END;
+        return;
+      }
+      switch (*pos_++)
+      {
+      case '+':
+        token_ = Token::PLUS;
+        return;
+      case '-':
+        token_ = Token::MINUS;
+        return;
+      case '*':
+        if (pos_ != end_ && *pos_ == '*')
+        {
+          ++pos_;
+          token_ = Token::POW;
+        }
+        else
+          token_ = Token::MUL;
+        return;
+      case '/':
+        token_ = Token::DIV;
+        return;
+      case '%':
+        token_ = Token::MOD;
+        return;
+      case '(':
+        token_ = Token::LPAR;
+        return;
+      case ')':
+        token_ = Token::RPAR;
+        return;
+      case '\n':
+        token_ = Token::NEWLINE;
+        return;
+      default:
+        pos_ = find_digit_run_end(pos_, end_);
+        token_ = Token::BIGNUM;
+      }
+    }
+
+    void PrattParser::expect(Token token)
+    {
+      if (token_ != token)
+        syntax_error();
+      next();
+    }
+
+    void PrattParser::error(const std::string& message)
+    {
+      auto& loc = driver_.get_location();
+      loc.begin.line = loc.end.line = line_;
+      loc.begin.column = token_begin_ - line_begin_ + 1;
+      loc.end.column = pos_ - line_begin_ + 1;
+      std::cerr << loc << ": " << message << '\n';
+      throw Error();
+    }
+
+    void PrattParser::syntax_error()
+    {
+      error("syntax error");
+    }
+  }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "ast-node.hh"
+#include "parse-driver.hh"
+
+namespace bistro
+{
+  namespace parser
+  {
+    /**
+    ** Hand-written parser of the grammar of parse-bistro.yy.
+    **
+    ** The lexer reads the buffer in place and the tokens are only a kind and
+    ** a range of the buffer: the nodes are built straight from the buffer,
+    ** with no symbol objects nor locations. A location is only computed to
+    ** report an error.
+    **
+    ** Expressions are parsed by precedence climbing: a chain of operators of
+    ** the same priority is parsed by a loop, so a wide expression costs no
+    ** recursion, only parentheses and unary operators do.
+    **/
+    class PrattParser
+    {
+    public:
+      using node_t = ParseDriver::node_t;
+
+      /// Parser of the \a size bytes at \a data, filling \a driver.
+      PrattParser(ParseDriver& driver, const char* data, size_t size);
+
+      /// Parse the input, and report the errors to the driver.
+      void parse();
+      /**
+      ** Parse the input, lines of expressions without the base header, in
+      ** the base of the driver.
+      **/
+      void parse_lines();
+
+    private:
+      enum class Token
+      {
+        BIGNUM,
+        PLUS,
+        MINUS,
+        MUL,
+        POW,
+        DIV,
+        MOD,
+        LPAR,
+        RPAR,
+        NEWLINE,
+        END,
+      };
+
+      /// Thrown on an error, once reported, to stop the parsing.
+      struct Error
+      {};
+
+      /// Read the base header.
+      void parse_header();
+      /// Parse the lines of expressions.
+      void lines();
+      /// Parse an expression of operators of priority \a power at least.
+      node_t parse_exp(int power);
+      /// Parse a number, a parenthesized expression or a unary operation.
+      node_t parse_operand();
+
+      /// Read the next token.
+      void next();
+      /// Read \a token, or report an error.
+      void expect(Token token);
+
+      /// Report \a message at the current token, and stop.
+      [[noreturn]] void error(const std::string& message);
+      /// Report an unexpected token.
+      [[noreturn]] void syntax_error();
+
+      ParseDriver& driver_;
+      const char* pos_;
+      const char* const end_;
+
+      /// Current token, and its range in the buffer.
+      Token token_ = Token::END;
+      const char* token_begin_ = nullptr;
+
+      /// Current line, and its start, for the locations.
+      size_t line_ = 1;
+      const char* line_begin_;
+    };
+  }
+}
@@ -1,11 +1,11 @@
-%option noyywrap noinput nounput
+%option noyywrap noinput nounput reentrant
 
 %{
 #include <iostream>
 #include <string>
 #include <vector>
 #include <stdexcept>
-#include <sstream>
+#include <string_view>
 #include "base.hh"
 #include "bignum.hh"
 #include "parse-bistro.hh"
@@ -18,34 +18,21 @@
 #define TOKEN_VAL(Type, Value)                            \
   yy::parser::make_ ## Type(Value, loc)
 #define yyterminate()                                     \
-  yy_delete_buffer(YY_CURRENT_BUFFER);                    \
   return TOKEN(EOF);
-static yy::location loc;
-static int base_length = 0;
-static int base_count = 0;
-static std::stringstream s;
 
+/* Build the number straight from the digit run matched in the buffer. */
 yy::parser::symbol_type
-complete_bignum(::bistro::parser::ParseDriver& p)
+complete_bignum(::bistro::parser::ParseDriver& p, std::string_view digits)
 {
+  yy::location& loc = p.get_location();
   try
   {
-    auto num = std::make_shared<num_t>(s, p.get_base());
-    if (s.peek() != EOF)
-    {
-      p.set_error();
-      std::cerr << loc << ": Invalid trailing characters"
-                << "\n";
-      yyterminate();
-    }
-    s.str("");
-    s.clear();
-    return TOKEN_VAL(BIGNUM, num);
+    return TOKEN_VAL(BIGNUM, p.make_number(digits));
   }
-  catch (std::length_error& e)
+  catch (std::out_of_range& e)
   {
     p.set_error();
-    std::cerr << e.what() << "\n";
+    std::cerr << loc << ": invalid digit in number.\n";
     yyterminate();
   }
 }
@@ -53,18 +40,30 @@ complete_bignum(::bistro::parser::ParseDriver& p)
 
 int           [0-9]+
 base_char     [^\+\*\-\/\%\(\)]
+digit_char    [^\+\*\-\/\%\(\)\n]
 
 
-%x BASE EXPRESSION BIGNUM
+%x BASE EXPRESSION
 
 
 %%
 %{
+  /* The scanner state lives in the driver, see scan_begin. */
+  yy::location& loc = p.get_location();
   loc.step();
 %}
 
 {int}         {
-                base_length = std::stoul(yytext);
+                try
+                {
+                  p.set_base_length(std::stoul(yytext));
+                }
+                catch (std::out_of_range& e)
+                {
+                  p.set_error();
+                  std::cerr << loc << ": invalid base length.\n";
+                  yyterminate();
+                }
                 return TOKEN(BASE_LEN);
               }
 
@@ -86,7 +85,7 @@ base_char     [^\+\*\-\/\%\(\)]
                  */
                 if (*yytext == '\n')
                   loc.lines();
-                if (base_count == base_length)
+                if (p.get_base_num() == p.get_base_length())
                 {
                   if (*yytext != '\n')
                   {
@@ -100,7 +99,7 @@ base_char     [^\+\*\-\/\%\(\)]
                 }
                 try
                 {
-                  p.get_base().add_digit(*yytext);
+                  p.add_digit(*yytext);
                 }
                 catch (std::invalid_argument& e)
                 {
@@ -108,8 +107,7 @@ base_char     [^\+\*\-\/\%\(\)]
                   std::cerr << e.what() << "\n";
                   yyterminate();
                 }
-                base_count++;
-                if (base_count == base_length)
+                if (p.get_base_num() == p.get_base_length())
                   return TOKEN(BASE);
               }
   .           {
@@ -129,27 +127,34 @@ base_char     [^\+\*\-\/\%\(\)]
   "%"         return TOKEN(MOD);
   "("         return TOKEN(LPAR);
   ")"         return TOKEN(RPAR);
-  {base_char} {
-                yyless(0);
-                loc.columns(-1);
-                BEGIN BIGNUM;
-              }
-}
-
-<BIGNUM>{
-  {base_char} {
-                s.put(*yytext);
-              }
-  .           {
-                yyless(0);
-                loc.columns(-1);
-                BEGIN EXPRESSION;
-                return complete_bignum(p);
-              }
-  <<EOF>>     {
-                BEGIN EXPRESSION;
-                return complete_bignum(p);
+  \n          loc.lines(); return TOKEN(NEWLINE);
+  {digit_char}+ {
+                return complete_bignum(p, std::string_view(yytext, yyleng));
               }
 }
 
 %%
+
+namespace bistro
+{
+  namespace parser
+  {
+    void ParseDriver::scan_begin(char* data, size_t size)
+    {
+      reset();
+      if (yylex_init(&scanner_))
+        throw std::runtime_error("Could not initialize scanner.");
+      if (!yy_scan_buffer(data, size, scanner_))
+      {
+        scan_end();
+        throw std::runtime_error("Could not scan buffer.");
+      }
+    }
+
+    void ParseDriver::scan_end()
+    {
+      yylex_destroy(scanner_);
+      scanner_ = nullptr;
+    }
+  }
+}
@@ -0,0 +1,297 @@
+#include "server.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unistd.h>
+#include <variant>
+
+#include "ast-rebalance.hh"
+#include "ast-simplify.hh"
+#include "bytecode.hh"
+
+namespace bistro
+{
+    Evaluator::Evaluator(const parser::ParseDriver& driver, ThreadPool& pool,
+                         double budget)
+        : driver_(driver)
+        , pool_(pool)
+        , budget_(budget)
+    {
+        driver.visit([this](const auto& program)
+        {
+            using program_t = std::decay_t<decltype(program)>;
+            passes_.emplace<Passes<typename program_t::num_t,
+                                   typename program_t::base_t>>();
+        });
+    }
+
+    Evaluator::node_t Evaluator::rewrite(const node_t& ast) const
+    {
+        return driver_.visit([&](const auto& program) -> node_t
+        {
+            using program_t = std::decay_t<decltype(program)>;
+            using num_t = typename program_t::num_t;
+            using base_t = typename program_t::base_t;
+            const auto& passes = std::get<Passes<num_t, base_t>>(passes_);
+            const auto& root = std::get<typename program_t::node_t>(ast);
+            auto tree = Simplifier<num_t, base_t>(passes.simplify,
+                                                  program.base)(*root);
+            return Rebalancer<num_t, base_t>(passes.rebalance)(*tree);
+        });
+    }
+
+    void Evaluator::share(const std::vector<node_t>& asts) const
+    {
+        driver_.visit([&](const auto& program)
+        {
+            using program_t = std::decay_t<decltype(program)>;
+            using num_t = typename program_t::num_t;
+            using base_t = typename program_t::base_t;
+            using ast_t = typename program_t::ast_t;
+
+            // Shared nodes by level, 0 being those without a shared node
+            // below them, found by a post-order keeping the level above
+            // each node on a stack.
+            std::vector<std::vector<const ast_t*>> levels;
+            std::unordered_map<const ast_t*, size_t> above;
+            std::vector<std::pair<const ast_t*, bool>> todo;
+            std::vector<const ast_t*> operands;
+            std::vector<size_t> heights;
+            for (const auto& ast : asts)
+            {
+                todo.emplace_back(
+                    std::get<typename program_t::node_t>(ast).get(), false);
+                while (!todo.empty())
+                {
+                    auto [node, ready] = todo.back();
+                    todo.pop_back();
+                    operands.clear();
+                    node->get_operands(operands);
+                    if (!ready)
+                    {
+                        auto it = above.find(node);
+                        if (it != above.end())
+                        {
+                            heights.push_back(it->second);
+                            continue;
+                        }
+                        todo.emplace_back(node, true);
+                        for (const auto* operand : operands)
+                            todo.emplace_back(operand, false);
+                        continue;
+                    }
+                    size_t level = 0;
+                    for (size_t i = 0; i < operands.size(); i++)
+                    {
+                        level = std::max(level, heights.back());
+                        heights.pop_back();
+                    }
+                    if (node->is_shared())
+                    {
+                        if (levels.size() <= level)
+                            levels.resize(level + 1);
+                        levels[level].push_back(node);
+                        above[node] = ++level;
+                    }
+                    heights.push_back(level);
+                }
+                heights.clear();
+            }
+
+            for (const auto& level : levels)
+                pool_.parallel_for(level.size(), [&](size_t i)
+                {
+                    try
+                    {
+                        auto code = Bytecode<num_t, base_t>::compile(*level[i]);
+                        code.check_budget(budget_);
+                        level[i]->get_memo()->set(
+                            std::make_shared<num_t>(code.run(&pool_)));
+                    }
+                    catch (std::exception&)
+                    {}
+                });
+        });
+    }
+
+    std::string Evaluator::run(const node_t& ast) const
+    {
+        return driver_.visit([&](const auto& program)
+        {
+            using program_t = std::decay_t<decltype(program)>;
+            using num_t = typename program_t::num_t;
+            using base_t = typename program_t::base_t;
+            const auto& root = std::get<typename program_t::node_t>(ast);
+            std::ostringstream out;
+            auto memo = root->get_memo();
+            if (auto value = memo ? memo->get() : nullptr)
+            {
+                value->print(out, program.base);
+                return out.str();
+            }
+            auto code = Bytecode<num_t, base_t>::compile(*root);
+            code.check_budget(budget_);
+            code.run(&pool_).print(out, program.base);
+            return out.str();
+        });
+    }
+
+    Server::Server(ThreadPool& pool, double budget, double cache)
+        : pool_(pool)
+        , budget_(budget)
+        , cache_max_(cache)
+    {}
+
+    void Server::serve(FILE* in, FILE* out)
+    {
+        parser::ParseDriver driver;
+        driver.set_parser(parser::ParseDriver::ParserType::PRATT);
+        // The base header: the base length, then the digits.
+        std::string header;
+        size_t header_lines = 0;
+        char* line = nullptr;
+        size_t capacity = 0;
+        ssize_t length;
+        while ((length = getline(&line, &capacity, in)) > 0)
+        {
+            if (header_lines < 2)
+            {
+                header.append(line, length);
+                if (++header_lines < 2)
+                    continue;
+                try
+                {
+                    driver.parse_string(header);
+                    continue;
+                }
+                catch (std::exception& e)
+                {
+                    std::fprintf(out, "error: %s\n", e.what());
+                    break;
+                }
+            }
+
+            std::string_view expr(line, length);
+            if (expr.back() == '\n')
+                expr.remove_suffix(1);
+            if (expr.empty())
+                continue;
+            std::string key = header;
+            key.append(expr);
+            std::string value;
+            if (!find(key, value))
+            {
+                try
+                {
+                    driver.parse_lines(expr);
+                    // The subtrees are shared within the line: whole lines
+                    // are shared by the cache.
+                    Evaluator evaluator(driver, pool_, budget_);
+                    value = evaluator.run(
+                        evaluator.rewrite(driver.get_ast()));
+                    store(std::move(key), value);
+                }
+                catch (std::exception& e)
+                {
+                    value = std::string("error: ") + e.what();
+                }
+            }
+            value += '\n';
+            std::fwrite(value.data(), 1, value.size(), out);
+            std::fflush(out);
+        }
+        std::fflush(out);
+        std::free(line);
+    }
+
+    void Server::listen(const std::string& path)
+    {
+        // A client leaving early must not kill the server.
+        std::signal(SIGPIPE, SIG_IGN);
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path))
+            throw std::runtime_error("Socket path too long.");
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            throw std::runtime_error("Could not create socket.");
+        unlink(path.c_str());
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0
+            || ::listen(fd, SOMAXCONN) < 0)
+        {
+            close(fd);
+            throw std::runtime_error("Could not listen on socket.");
+        }
+        for (;;)
+        {
+            int client = accept(fd, nullptr, nullptr);
+            if (client < 0)
+            {
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+                close(fd);
+                throw std::runtime_error("Could not accept client.");
+            }
+            std::thread([this, client]()
+            {
+                int client_out = dup(client);
+                FILE* in = fdopen(client, "r");
+                FILE* out = client_out < 0 ? nullptr : fdopen(client_out, "w");
+                if (in && out)
+                    serve(in, out);
+                if (in)
+                    std::fclose(in);
+                else
+                    close(client);
+                if (out)
+                    std::fclose(out);
+                else if (client_out >= 0)
+                    close(client_out);
+            }).detach();
+        }
+    }
+
+    bool Server::find(const std::string& key, std::string& value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end())
+            return false;
+        values_.splice(values_.begin(), values_, it->second);
+        value = it->second->second;
+        return true;
+    }
+
+    void Server::store(std::string key, std::string value)
+    {
+        size_t size = key.size() + value.size();
+        if (size > cache_max_)
+            return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Another session may have stored it meanwhile.
+        if (index_.count(key))
+            return;
+        values_.emplace_front(std::move(key), std::move(value));
+        index_.emplace(values_.front().first, values_.begin());
+        cache_size_ += size;
+        while (cache_size_ > cache_max_)
+        {
+            const auto& last = values_.back();
+            cache_size_ -= last.first.size() + last.second.size();
+            index_.erase(last.first);
+            values_.pop_back();
+        }
+    }
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ast-shared.hh"
+#include "parse-driver.hh"
+#include "thread-pool.hh"
+
+namespace bistro
+{
+    /**
+    ** Evaluation of the expressions of the program parsed by a driver.
+    **
+    ** An expression is rewritten first: its trivial operations are
+    ** simplified, and its chains of + and * balanced. It is then compiled to
+    ** a Bytecode, run on a pool, and its value printed in the base of the
+    ** program.
+    **
+    ** Each rewriting pass builds its nodes with a SharedASTFactory kept for
+    ** all the expressions of the evaluator: a subtree repeated across them
+    ** is a single node, computed by the first program needing it, and kept
+    ** for the others, as long as they are all rewritten before being run,
+    ** see share. Rewriting and running may be run concurrently.
+    **/
+    class Evaluator
+    {
+    public:
+        /// Node of the program parsed.
+        using node_t = parser::ParseDriver::node_t;
+
+        /**
+        ** Evaluator of the expressions parsed by \a driver, on \a pool,
+        ** within \a budget bytes for each.
+        **/
+        Evaluator(const parser::ParseDriver& driver, ThreadPool& pool,
+                  double budget);
+
+        /// Rewrite \a ast, of the program parsed by the driver.
+        node_t rewrite(const node_t& ast) const;
+
+        /**
+        ** Compute the shared nodes of \a asts, rewritten, and keep their
+        ** values in their memo (see ASTNode::get_memo), for run to reuse.
+        **
+        ** Each is computed once, after the shared nodes below it: the nodes
+        ** of a level are computed concurrently, which run couldn't do
+        ** without computing a node needed by concurrent runs several times.
+        ** A node whose computation fails is left to the runs, to report the
+        ** error.
+        **/
+        void share(const std::vector<node_t>& asts) const;
+
+        /**
+        ** Evaluate \a ast, rewritten, and return its value printed in the
+        ** base of the program.
+        **
+        ** \throw std::length_error if the evaluation may need more than the
+        ** budget, or the exception thrown by the evaluation, e.g. for a
+        ** division by 0.
+        **/
+        std::string run(const node_t& ast) const;
+
+    private:
+        /// Factories of the rewriting passes.
+        template <typename BigNum, typename Base>
+        struct Passes
+        {
+            SharedASTFactory<BigNum, Base> simplify;
+            SharedASTFactory<BigNum, Base> rebalance;
+        };
+
+        const parser::ParseDriver& driver_;
+        ThreadPool& pool_;
+        double budget_;
+        parser::ParseDriver::programs_t::apply_t<Passes> passes_;
+    };
+
+    /**
+    ** Long-running evaluation of the expressions sent by clients.
+    **
+    ** A session starts with the base header, as in a file, followed by one
+    ** expression per line. Each expression is answered by a line holding its
+    ** value, or "error: " and the reason. The base is read once per session.
+    **
+    ** The process keeps the values of the expressions already evaluated
+    ** from a request to the next: an expression sent again in the same
+    ** base, by any session, is answered from the cache.
+    **/
+    class Server
+    {
+    public:
+        /**
+        ** Server evaluating on \a pool within \a budget bytes per expression,
+        ** and keeping up to \a cache bytes of values.
+        **/
+        Server(ThreadPool& pool, double budget, double cache);
+
+        /// Serve a session reading from \a in and answering to \a out.
+        void serve(FILE* in, FILE* out);
+
+        /**
+        ** Listen on the Unix socket \a path, and serve each client in its own
+        ** thread.
+        **
+        ** \throw std::runtime_error if the socket cannot be set up.
+        **/
+        [[noreturn]] void listen(const std::string& path);
+
+    private:
+        /// Get the value cached for \a key in \a value, if any.
+        bool find(const std::string& key, std::string& value);
+        /// Cache \a value for \a key, dropping the least recently used values.
+        void store(std::string key, std::string value);
+
+        ThreadPool& pool_;
+        double budget_;
+
+        /// Values, by header and expression, the most recently used first.
+        std::mutex mutex_;
+        std::list<std::pair<std::string, std::string>> values_;
+        std::unordered_map<std::string_view,
+                           decltype(values_)::iterator> index_;
+        size_t cache_size_ = 0;
+        double cache_max_;
+    };
+}
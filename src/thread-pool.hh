@@ -0,0 +1,377 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bistro
+{
+    /**
+    ** Work-stealing thread pool.
+    **
+    ** Each worker has its own deque of tasks: join pushes a task at the
+    ** bottom of the deque of the calling worker, and the idle workers steal
+    ** tasks from the top of the deques of the others. The deques are
+    ** lock-free (Chase-Lev), so forking a task costs a few atomic operations,
+    ** and is mostly undone by the owner itself when nobody stole it.
+    **
+    ** A thread outside the pool hands its work to the workers, see run.
+    **/
+    class ThreadPool
+    {
+    public:
+        /// Pool of \a jobs workers, one per core with \a jobs = 0.
+        explicit ThreadPool(size_t jobs)
+        {
+            if (jobs == 0)
+                jobs = std::max(1u, std::thread::hardware_concurrency());
+            // With a single job, the tasks are run inline.
+            if (jobs == 1)
+                return;
+            for (size_t i = 0; i < jobs; i++)
+                deques_.push_back(std::make_unique<Deque>());
+            for (size_t i = 0; i < jobs; i++)
+                threads_.emplace_back([this, i]() { work(i); });
+        }
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            cv_.notify_all();
+            for (auto& t : threads_)
+                t.join();
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /// Number of threads running the tasks.
+        size_t size() const
+        {
+            return std::max<size_t>(threads_.size(), 1);
+        }
+
+        /**
+        ** Run \a f on a worker, and return once it is done.
+        **
+        ** \throw the exception thrown by \a f, if any.
+        **/
+        template <typename F>
+        void run(F&& f)
+        {
+            if (threads_.empty() || current_pool_ == this)
+                return f();
+            TaskJob<F> job(f);
+            job.injected = true;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                injected_.push_back(&job);
+                nb_injected_++;
+            }
+            cv_.notify_one();
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_cv_.wait(lock, [&job]() { return job.done.load(); });
+            if (job.error)
+                std::rethrow_exception(job.error);
+        }
+
+        /**
+        ** Run \a a and \a b, possibly in parallel, and return once both are
+        ** done.
+        **
+        ** \a b is offered to the other workers while \a a runs; if nobody
+        ** took it, it is run right after \a a. Otherwise, the worker runs
+        ** other tasks until \a b is done.
+        **
+        ** \throw the exception thrown by \a a, or else by \a b.
+        **/
+        template <typename A, typename B>
+        void join(A&& a, B&& b)
+        {
+            if (threads_.empty())
+            {
+                a();
+                b();
+                return;
+            }
+            if (current_pool_ != this)
+                return run([&]() { join(a, b); });
+
+            Deque& deque = *deques_[current_index_];
+            TaskJob<B> job(b);
+            if (!deque.push(&job))
+            {
+                a();
+                b();
+                return;
+            }
+            if (sleeping_.load())
+                wake();
+
+            std::exception_ptr error;
+            try
+            {
+                a();
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+            if (deque.pop() == &job)
+                execute(&job);
+            else
+                while (!job.done.load(std::memory_order_acquire))
+                    if (Job* other = find(current_index_))
+                        execute(other);
+                    else
+                        std::this_thread::yield();
+            if (error)
+                std::rethrow_exception(error);
+            if (job.error)
+                std::rethrow_exception(job.error);
+        }
+
+        /**
+        ** Run \a task on every index of [0, \a n), by splitting the range in
+        ** halves with join, so that the workers steal large ranges.
+        **/
+        template <typename Task>
+        void parallel_for(size_t n, const Task& task)
+        {
+            if (n)
+                split(0, n, task);
+        }
+
+    private:
+        /// Task offered to the workers.
+        struct Job
+        {
+            void (*call)(Job*);
+            std::atomic<bool> done = false;
+            bool injected = false;
+            std::exception_ptr error;
+        };
+
+        /// Job running a callable, kept by the caller until the job is done.
+        template <typename F>
+        struct TaskJob : Job
+        {
+            explicit TaskJob(F& f)
+                : f_(f)
+            {
+                this->call = &TaskJob::invoke;
+            }
+
+            static void invoke(Job* job)
+            {
+                auto self = static_cast<TaskJob*>(job);
+                try
+                {
+                    self->f_();
+                }
+                catch (...)
+                {
+                    self->error = std::current_exception();
+                }
+            }
+
+            F& f_;
+        };
+
+        /**
+        ** Chase-Lev deque, of fixed capacity: the owner pushes and pops at
+        ** the bottom, the thieves steal at the top.
+        **/
+        class Deque
+        {
+        public:
+            /// Push \a job, or return false if the deque is full.
+            bool push(Job* job)
+            {
+                int64_t b = bottom_.load(std::memory_order_relaxed);
+                int64_t t = top_.load(std::memory_order_acquire);
+                if (b - t >= capacity)
+                    return false;
+                jobs_[b & (capacity - 1)].store(job,
+                                                std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                bottom_.store(b + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                return true;
+            }
+
+            /// Pop the last job pushed, or return nullptr if it was stolen.
+            Job* pop()
+            {
+                int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+                bottom_.store(b, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                int64_t t = top_.load(std::memory_order_relaxed);
+                Job* job = nullptr;
+                if (t <= b)
+                {
+                    job = jobs_[b & (capacity - 1)].load(
+                        std::memory_order_relaxed);
+                    if (t == b
+                        && !top_.compare_exchange_strong(
+                            t, t + 1, std::memory_order_seq_cst,
+                            std::memory_order_relaxed))
+                        job = nullptr;
+                    else if (t != b)
+                        return job;
+                }
+                bottom_.store(b + 1, std::memory_order_relaxed);
+                return job;
+            }
+
+            /// Steal the first job pushed, or return nullptr.
+            Job* steal()
+            {
+                int64_t t = top_.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                int64_t b = bottom_.load(std::memory_order_acquire);
+                if (t >= b)
+                    return nullptr;
+                Job* job = jobs_[t & (capacity - 1)].load(
+                    std::memory_order_relaxed);
+                if (!top_.compare_exchange_strong(t, t + 1,
+                                                  std::memory_order_seq_cst,
+                                                  std::memory_order_relaxed))
+                    return nullptr;
+                return job;
+            }
+
+            /// Whether the deque seems not empty.
+            bool busy() const
+            {
+                return top_.load() < bottom_.load();
+            }
+
+        private:
+            static constexpr int64_t capacity = 1 << 13;
+
+            std::atomic<int64_t> top_ = 0;
+            std::atomic<int64_t> bottom_ = 0;
+            std::atomic<Job*> jobs_[capacity] = {};
+        };
+
+        template <typename Task>
+        void split(size_t first, size_t last, const Task& task)
+        {
+            if (last - first == 1)
+                return task(first);
+            size_t mid = first + (last - first) / 2;
+            join([&]() { split(first, mid, task); },
+                 [&]() { split(mid, last, task); });
+        }
+
+        /// Run \a job, and signal its end.
+        void execute(Job* job)
+        {
+            bool injected = job->injected;
+            job->call(job);
+            job->done.store(true, std::memory_order_release);
+            // The job may not exist anymore.
+            if (injected)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                done_cv_.notify_all();
+            }
+        }
+
+        /// Find a job for the worker \a self: steal one, or take one injected.
+        Job* find(size_t self)
+        {
+            size_t n = deques_.size();
+            for (size_t i = 1; i < n; i++)
+                if (Job* job = deques_[(self + i) % n]->steal())
+                    return job;
+            if (nb_injected_.load())
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!injected_.empty())
+                {
+                    Job* job = injected_.front();
+                    injected_.pop_front();
+                    nb_injected_--;
+                    return job;
+                }
+            }
+            return nullptr;
+        }
+
+        /// Whether some job may be found, \a mutex_ being locked.
+        bool has_work() const
+        {
+            if (!injected_.empty())
+                return true;
+            for (const auto& deque : deques_)
+                if (deque->busy())
+                    return true;
+            return false;
+        }
+
+        /// Wake a sleeping worker.
+        void wake()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cv_.notify_one();
+        }
+
+        /// Body of the worker \a index.
+        void work(size_t index)
+        {
+            current_pool_ = this;
+            current_index_ = index;
+            size_t idle = 0;
+            while (!stop_)
+            {
+                if (Job* job = find(index))
+                {
+                    execute(job);
+                    idle = 0;
+                    continue;
+                }
+                if (++idle < 64)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(mutex_);
+                sleeping_++;
+                if (!stop_ && !has_work())
+                    cv_.wait_for(lock, std::chrono::milliseconds(10));
+                sleeping_--;
+                idle = 0;
+            }
+        }
+
+        std::vector<std::unique_ptr<Deque>> deques_;
+        std::vector<std::thread> threads_;
+
+        /// Protects the jobs of the threads outside the pool, and the sleeps.
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::condition_variable done_cv_;
+        std::deque<Job*> injected_;
+        std::atomic<size_t> nb_injected_ = 0;
+        std::atomic<size_t> sleeping_ = 0;
+        std::atomic<bool> stop_ = false;
+
+        /// Pool and index of the current worker thread.
+        static inline thread_local ThreadPool* current_pool_ = nullptr;
+        static inline thread_local size_t current_index_ = 0;
+    };
+}